@@ -8,256 +8,1819 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
 #include "algoritmos.h"
 #include "grafo.h"
+#include "estatisticas.h"
 
 Schedule* create_schedule() {
-    Schedule* s = (Schedule*)malloc(sizeof(Schedule));
+    return create_schedule_in(NULL);
+}
+
+Schedule* create_schedule_in(Arena* arena) {
+    Schedule* s = (Schedule*)arena_alloc(arena, sizeof(Schedule));
     if (!s) {
         perror("Falha ao alocar Schedule");
         return NULL;
     }
+    s->arena = arena;
     s->op_count = 0;
     s->op_capacity = 10; // Capacidade inicial
-    s->ops = (Operation*)malloc(s->op_capacity * sizeof(Operation));
+    s->ops = (Operation*)arena_alloc(arena, s->op_capacity * sizeof(Operation));
     if (!s->ops) {
         perror("Falha ao alocar array de operações");
-        free(s);
+        arena_free(arena, s);
         return NULL;
     }
     s->trans_ids = NULL;
     s->trans_count = 0;
+    s->attr_count = 0;
+    s->owns_data = 1;
+    memset(&s->cols, 0, sizeof(OpColumns));
     return s;
 }
 
+// Descarta as colunas (e as listas), que são recalculadas quando pedidas.
+static void free_columns(Schedule* s) {
+    OpColumns* c = &s->cols;
+    arena_free(s->arena, c->by_attr);
+    arena_free(s->arena, c->by_attr_start);
+    arena_free(s->arena, c->by_trans);
+    arena_free(s->arena, c->by_trans_start);
+    arena_free(s->arena, c->kind);
+    arena_free(s->arena, c->attr);
+    arena_free(s->arena, c->trans);
+    memset(c, 0, sizeof(OpColumns));
+}
+
 void free_schedule(Schedule* s) {
     if (!s) return;
-    free(s->ops);
-    free(s->trans_ids);
-    free(s);
+    free_columns(s);
+    if (s->owns_data) {
+        arena_free(s->arena, s->ops);
+        arena_free(s->arena, s->trans_ids);
+    }
+    arena_free(s->arena, s);
 }
 
-void add_operation(Schedule* s, int time, int trans_id, char op, char attr) {
+void add_operation(Schedule* s, int time, int trans_id, char op, int attr) {
     // Redimensiona o array de operações se necessário
     if (s->op_count >= s->op_capacity) {
-        s->op_capacity *= 2;
-        Operation* new_ops = (Operation*)realloc(s->ops, s->op_capacity * sizeof(Operation));
+        Operation* new_ops = (Operation*)arena_realloc(s->arena, s->ops, s->op_capacity * sizeof(Operation),
+                                                       2 * s->op_capacity * sizeof(Operation));
         if (!new_ops) {
             perror("Falha ao realocar array de operações");
             // A aplicação irá parar, mas em um sistema real, trataria o erro
             return;
         }
         s->ops = new_ops;
+        s->op_capacity *= 2;
     }
-    s->ops[s->op_count++] = (Operation){time, trans_id, op, attr};
+    s->ops[s->op_count++] = (Operation){time, trans_id, -1, attr, NO_ATTR, op};
 }
 
 // Função de comparação para qsort
 int compare_ints(const void* a, const void* b) {
-    return (*(int*)a - *(int*)b);
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
 }
 
-void find_unique_transactions(Schedule* s) {
-    if (s->op_count == 0) return;
+// --- Remapeamento de ID de Transação para Índice Denso ---
+
+// IDs cuja faixa (max - min) cabe neste limite, relativo ao número de
+// operações, são remapeados por um vetor indexado diretamente.
+#define DIRECT_MAP_FACTOR 4
+
+// Tabela hash de endereçamento aberto (sondagem linear) de int para int.
+typedef struct {
+    Arena* arena;
+    int* keys;
+    int* values;
+    int* used;
+    int mask;
+} IntMap;
+
+static unsigned int hash_int(int key) {
+    unsigned int x = (unsigned int)key;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+static void intmap_free(IntMap* m) {
+    arena_free(m->arena, m->keys);
+    arena_free(m->arena, m->values);
+    arena_free(m->arena, m->used);
+}
+
+static int intmap_init(IntMap* m, Arena* arena, int expected) {
+    int cap = 16;
+    while (cap < expected * 2) cap <<= 1;
+    m->arena = arena;
+    m->mask = cap - 1;
+    m->keys = (int*)arena_alloc(arena, cap * sizeof(int));
+    m->values = (int*)arena_alloc(arena, cap * sizeof(int));
+    m->used = (int*)arena_calloc(arena, cap, sizeof(int));
+    if (!m->keys || !m->values || !m->used) {
+        intmap_free(m);
+        return 0;
+    }
+    return 1;
+}
+
+// Retorna a posição da chave na tabela, inserindo-a (com valor -1) se ausente.
+static int intmap_slot(IntMap* m, int key, int* inserted) {
+    int i = (int)(hash_int(key) & (unsigned int)m->mask);
+    while (m->used[i]) {
+        if (m->keys[i] == key) {
+            *inserted = 0;
+            return i;
+        }
+        i = (i + 1) & m->mask;
+    }
+    m->used[i] = 1;
+    m->keys[i] = key;
+    m->values[i] = -1;
+    *inserted = 1;
+    return i;
+}
 
-    int* temp_ids = (int*)malloc(s->op_count * sizeof(int));
+// Remapeamento por vetor direto, para IDs numa faixa pequena.
+static int remap_direct(Schedule* s, int min_id, int range) {
+    int* slot = (int*)arena_alloc(s->arena, range * sizeof(int));
+    if (!slot) return 0;
+    for (int i = 0; i < range; i++) slot[i] = -1;
+
+    for (int i = 0; i < s->op_count; i++) {
+        slot[s->ops[i].trans_id - min_id] = 0;
+    }
+
+    // Percorrer a faixa em ordem já produz os IDs ordenados.
     int count = 0;
+    for (int i = 0; i < range; i++) {
+        if (slot[i] == 0) {
+            s->trans_ids[count] = min_id + i;
+            slot[i] = count++;
+        }
+    }
+    s->trans_count = count;
+
+    for (int i = 0; i < s->op_count; i++) {
+        s->ops[i].trans_idx = slot[s->ops[i].trans_id - min_id];
+    }
+    arena_free(s->arena, slot);
+    return 1;
+}
+
+// Remapeamento por tabela hash, para IDs esparsos.
+static int remap_hashed(Schedule* s) {
+    IntMap m;
+    if (!intmap_init(&m, s->arena, s->op_count)) return 0;
+
+    int count = 0;
+    int inserted;
+    for (int i = 0; i < s->op_count; i++) {
+        intmap_slot(&m, s->ops[i].trans_id, &inserted);
+        if (inserted) {
+            s->trans_ids[count++] = s->ops[i].trans_id;
+        }
+    }
+    s->trans_count = count;
+
+    // Ordena os IDs para consistência e usa a posição como índice denso
+    qsort(s->trans_ids, count, sizeof(int), compare_ints);
+    for (int i = 0; i < count; i++) {
+        m.values[intmap_slot(&m, s->trans_ids[i], &inserted)] = i;
+    }
+
+    for (int i = 0; i < s->op_count; i++) {
+        s->ops[i].trans_idx = m.values[intmap_slot(&m, s->ops[i].trans_id, &inserted)];
+    }
+    intmap_free(&m);
+    return 1;
+}
+
+// Remapeia os IDs globais de atributo para índices densos, na ordem de
+// primeira aparição. Retorna 0 em erro.
+static int remap_attributes(Schedule* s) {
+    int min_id = -1, max_id = -1;
     for (int i = 0; i < s->op_count; i++) {
-        int found = 0;
-        for (int j = 0; j < count; j++) {
-            if (temp_ids[j] == s->ops[i].trans_id) {
-                found = 1;
-                break;
+        int a = s->ops[i].attr;
+        if (a == NO_ATTR) continue;
+        if (min_id == -1 || a < min_id) min_id = a;
+        if (a > max_id) max_id = a;
+    }
+
+    int count = 0;
+    long long range = (long long)max_id - min_id + 1;
+    if (max_id == -1) {
+        for (int i = 0; i < s->op_count; i++) s->ops[i].attr_idx = NO_ATTR;
+    } else if (range <= (long long)s->op_count * DIRECT_MAP_FACTOR) {
+        // IDs globais são atribuídos em ordem de chegada, então os de um
+        // escalonamento costumam ocupar uma faixa estreita
+        int* slot = (int*)arena_alloc(s->arena, range * sizeof(int));
+        if (!slot) return 0;
+        for (int i = 0; i < range; i++) slot[i] = -1;
+        for (int i = 0; i < s->op_count; i++) {
+            Operation* op = &s->ops[i];
+            if (op->attr == NO_ATTR) {
+                op->attr_idx = NO_ATTR;
+                continue;
             }
+            int* dense = &slot[op->attr - min_id];
+            if (*dense == -1) *dense = count++;
+            op->attr_idx = *dense;
         }
-        if (!found) {
-            temp_ids[count++] = s->ops[i].trans_id;
+        arena_free(s->arena, slot);
+    } else {
+        IntMap m;
+        if (!intmap_init(&m, s->arena, s->op_count)) return 0;
+        int inserted;
+        for (int i = 0; i < s->op_count; i++) {
+            Operation* op = &s->ops[i];
+            if (op->attr == NO_ATTR) {
+                op->attr_idx = NO_ATTR;
+                continue;
+            }
+            int k = intmap_slot(&m, op->attr, &inserted);
+            if (inserted) m.values[k] = count++;
+            op->attr_idx = m.values[k];
         }
+        intmap_free(&m);
     }
+    s->attr_count = count;
+    return 1;
+}
 
-    s->trans_ids = (int*)malloc(count * sizeof(int));
-    memcpy(s->trans_ids, temp_ids, count * sizeof(int));
-    s->trans_count = count;
-    free(temp_ids);
+void find_unique_transactions(Schedule* s) {
+    if (s->op_count == 0) return;
+    free_columns(s);
 
-    // Ordena os IDs para consistência
-    qsort(s->trans_ids, s->trans_count, sizeof(int), compare_ints);
+    arena_free(s->arena, s->trans_ids);
+    s->trans_ids = (int*)arena_alloc(s->arena, s->op_count * sizeof(int));
+    if (!s->trans_ids) {
+        perror("Falha ao alocar IDs de transações");
+        s->trans_count = 0;
+        return;
+    }
+
+    int min_id = s->ops[0].trans_id, max_id = s->ops[0].trans_id;
+    for (int i = 1; i < s->op_count; i++) {
+        if (s->ops[i].trans_id < min_id) min_id = s->ops[i].trans_id;
+        if (s->ops[i].trans_id > max_id) max_id = s->ops[i].trans_id;
+    }
+
+    long long range = (long long)max_id - min_id + 1;
+    int ok;
+    if (range <= (long long)s->op_count * DIRECT_MAP_FACTOR) {
+        ok = remap_direct(s, min_id, (int)range);
+    } else {
+        ok = remap_hashed(s);
+    }
+    if (!ok) {
+        perror("Falha ao remapear IDs de transações");
+        s->trans_count = 0;
+    }
+    if (!remap_attributes(s)) {
+        perror("Falha ao remapear atributos");
+        s->trans_count = 0;
+        s->attr_count = 0;
+    }
 }
 
-// --- Mapeamento de ID de Transação para Índice do Grafo ---
+// --- Colunas e Listas de Operações ---
 
-int get_trans_index(Schedule* s, int trans_id) {
-    for (int i = 0; i < s->trans_count; i++) {
-        if (s->trans_ids[i] == trans_id) {
-            return i;
-        }
+int schedule_columns(Schedule* s) {
+    OpColumns* c = &s->cols;
+    if (c->trans) return 1;
+    int n = s->op_count;
+    c->trans = (int*)arena_alloc(s->arena, (n + 1) * sizeof(int));
+    c->attr = (int*)arena_alloc(s->arena, (n + 1) * sizeof(int));
+    c->kind = (unsigned char*)arena_alloc(s->arena, n + 1);
+    if (!c->trans || !c->attr || !c->kind) {
+        perror("Falha ao alocar colunas do escalonamento");
+        free_columns(s);
+        return 0;
     }
-    return -1; // Não deve acontecer
+    for (int i = 0; i < n; i++) {
+        const Operation* op = &s->ops[i];
+        c->trans[i] = op->trans_idx;
+        c->attr[i] = op->attr_idx;
+        c->kind[i] = op->op == 'R' ? OP_READ : op->op == 'W' ? OP_WRITE : op->op == 'C' ? OP_COMMIT : OP_OTHER;
+    }
+    return 1;
+}
+
+// Ordenação estável por contagem dos índices das operações pela chave
+// key[i] (em [0, keys), ou negativa para ficar de fora). 0 em erro.
+static int group_ops(Arena* arena, const int* key, int n, int keys, int** start_out, int** list_out) {
+    int* start = (int*)arena_calloc(arena, keys + 2, sizeof(int));
+    int* list = (int*)arena_alloc(arena, (n + 1) * sizeof(int));
+    if (!start || !list) {
+        arena_free(arena, list);
+        arena_free(arena, start);
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        if (key[i] >= 0) start[key[i] + 2]++;
+    }
+    for (int k = 0; k < keys; k++) start[k + 2] += start[k + 1];
+    for (int i = 0; i < n; i++) {
+        if (key[i] >= 0) list[start[key[i] + 1]++] = i;
+    }
+    *start_out = start;
+    *list_out = list;
+    return 1;
+}
+
+int schedule_ops_by_trans(Schedule* s) {
+    if (s->cols.by_trans) return 1;
+    if (!schedule_columns(s)) return 0;
+    if (!group_ops(s->arena, s->cols.trans, s->op_count, s->trans_count,
+                   &s->cols.by_trans_start, &s->cols.by_trans)) {
+        perror("Falha ao alocar operações por transação");
+        return 0;
+    }
+    return 1;
+}
+
+int schedule_ops_by_attr(Schedule* s) {
+    if (s->cols.by_attr) return 1;
+    if (!schedule_columns(s)) return 0;
+    // NO_ATTR é negativo: os commits ficam fora das listas
+    if (!group_ops(s->arena, s->cols.attr, s->op_count, s->attr_count,
+                   &s->cols.by_attr_start, &s->cols.by_attr)) {
+        perror("Falha ao alocar operações por atributo");
+        return 0;
+    }
+    return 1;
 }
 
 // --- Algoritmo de Seriabilidade por Conflito ---
 
+// Número de threads da geração de arestas (ver set_conflict_threads).
+static int conflict_threads = 1;
+
+void set_conflict_threads(int threads) {
+    conflict_threads = (threads > 0) ? threads : 1;
+}
+
+// Geração das arestas em paralelo: as arestas de uma operação só dependem
+// da última escrita e dos leitores do seu atributo, então cada thread
+// percorre as listas por atributo de uma faixa de atributos com o mesmo
+// índice de conflitos da passada serial. No grafo denso, a primeira faixa
+// marca o próprio grafo, as outras uma matriz própria, e as matrizes são
+// unidas no fim. No esparso a ordem das arestas decide a ordem da DFS: uma
+// primeira passada conta quantas arestas cada operação gera, e a segunda
+// grava cada aresta na posição da sua operação no tempo, na mesma ordem da
+// passada serial. Tudo sai da arena do escalonamento, alocado pela thread
+// que a possui antes de as faixas começarem.
+typedef struct {
+    Schedule* s;
+    int attr_begin, attr_end;  // Faixa de atributos [attr_begin, attr_end)
+    int* reader_next;          // Compartilhados: cada operação é de uma faixa só
+    int* op_edges;             // Arestas por operação; depois, início de cada uma (esparso)
+    Graph* local;              // Matriz da faixa (denso)
+    int* merged_from;          // Arestas em ordem de tempo, na segunda passada (esparso)
+    int* merged_to;
+    int cursor;                // Próxima posição em merged_from/merged_to
+    long long edges;
+    int ok;
+    pthread_t thread;
+    int started;
+} ConflictShard;
+
+static void shard_edge(ConflictShard* sh, int from, int to) {
+    sh->edges++;
+    if (sh->local) {
+        if (!add_edge(sh->local, from, to)) sh->ok = 0;
+    } else if (sh->merged_from) {
+        sh->merged_from[sh->cursor] = from;
+        sh->merged_to[sh->cursor] = to;
+        sh->cursor++;
+    }
+}
+
+static void* shard_scan(void* arg) {
+    ConflictShard* sh = (ConflictShard*)arg;
+    Schedule* s = sh->s;
+    const int* col_trans = s->cols.trans;
+    const unsigned char* col_kind = s->cols.kind;
+    const int* start = s->cols.by_attr_start;
+    const int* list = s->cols.by_attr;
+    int counting = sh->op_edges && !sh->merged_from;
+
+    for (int a = sh->attr_begin; a < sh->attr_end && sh->ok; a++) {
+        int last_writer = -1;
+        int readers_head = -1;
+        for (int k = start[a]; k < start[a + 1]; k++) {
+            int i = list[k];
+            int kind = col_kind[i];
+            if (kind > OP_WRITE) continue;
+            int t = col_trans[i];
+            long long before = sh->edges;
+            if (sh->merged_from) sh->cursor = sh->op_edges[i];
+
+            if (last_writer != -1 && last_writer != t) shard_edge(sh, last_writer, t);
+            if (kind == OP_READ) {
+                sh->reader_next[i] = readers_head;
+                readers_head = i;
+            } else {
+                for (int r = readers_head; r != -1; r = sh->reader_next[r]) {
+                    if (col_trans[r] != t) shard_edge(sh, col_trans[r], t);
+                }
+                readers_head = -1;
+                last_writer = t;
+            }
+            if (counting) sh->op_edges[i] = (int)(sh->edges - before);
+        }
+    }
+    return NULL;
+}
+
+// Roda fn em cada faixa: a thread atual fica com a primeira, e uma faixa
+// cuja thread não pôde ser criada também roda aqui.
+static void run_shards(ConflictShard* shards, int count, void* (*fn)(void*)) {
+    for (int i = 1; i < count; i++) {
+        shards[i].started = pthread_create(&shards[i].thread, NULL, fn, &shards[i]) == 0;
+    }
+    fn(&shards[0]);
+    for (int i = 1; i < count; i++) {
+        if (shards[i].started) pthread_join(shards[i].thread, NULL);
+        else fn(&shards[i]);
+    }
+}
+
+/**
+ * @brief Gera as arestas de conflito em paralelo, por faixas de atributos.
+ * @param s O escalonamento.
+ * @param g O grafo (vazio) que recebe as arestas.
+ * @param threads Número de faixas (no máximo attr_count).
+ * @return 1 em caso de sucesso, 0 em erro.
+ */
+static int shard_conflicts(Schedule* s, Graph* g, int threads) {
+    if (!schedule_ops_by_attr(s)) return 0;
+    const int* start = s->cols.by_attr_start;
+    int sparse = g->mode == GRAPH_SPARSE;
+
+    ConflictShard* shards = (ConflictShard*)arena_calloc(s->arena, threads, sizeof(ConflictShard));
+    int* reader_next = (int*)arena_alloc(s->arena, (s->op_count + 1) * sizeof(int));
+    int* op_edges = sparse ? (int*)arena_calloc(s->arena, s->op_count + 1, sizeof(int)) : NULL;
+    int ok = shards && reader_next && (!sparse || op_edges);
+
+    // Faixas contíguas com números parecidos de operações
+    long long total = start[s->attr_count];
+    int a = 0;
+    for (int i = 0; ok && i < threads; i++) {
+        ConflictShard* sh = &shards[i];
+        sh->s = s;
+        sh->reader_next = reader_next;
+        sh->op_edges = op_edges;
+        sh->ok = 1;
+        sh->attr_begin = a;
+        long long goal = total * (i + 1) / threads;
+        while (a < s->attr_count && (i == threads - 1 || start[a + 1] <= goal || a == sh->attr_begin)) a++;
+        sh->attr_end = a;
+        if (!sparse) {
+            sh->local = (i == 0) ? g : create_graph_in(s->arena, g->num_vertices, GRAPH_DENSE);
+            ok = sh->local != NULL;
+        }
+    }
+    if (!ok) perror("Falha ao alocar índice de conflitos");
+
+    long long edges = 0;
+    if (ok) {
+        run_shards(shards, threads, shard_scan);
+        for (int i = 0; i < threads; i++) {
+            ok = ok && shards[i].ok;
+            edges += shards[i].edges;
+        }
+        if (!ok) perror("Falha ao alocar arestas de conflito");
+    }
+
+    if (ok && !sparse) {
+        for (int i = 1; ok && i < threads; i++) ok = graph_merge(g, shards[i].local);
+    } else if (ok) {
+        // Contagens por operação viram inícios (soma de prefixos)
+        int sum = 0;
+        for (int i = 0; i < s->op_count; i++) {
+            int count = op_edges[i];
+            op_edges[i] = sum;
+            sum += count;
+        }
+        op_edges[s->op_count] = sum;
+        int* merged_from = (int*)arena_alloc(s->arena, (sum + 1) * sizeof(int));
+        int* merged_to = (int*)arena_alloc(s->arena, (sum + 1) * sizeof(int));
+        ok = merged_from && merged_to;
+        if (ok) {
+            for (int i = 0; i < threads; i++) {
+                shards[i].merged_from = merged_from;
+                shards[i].merged_to = merged_to;
+            }
+            run_shards(shards, threads, shard_scan);
+            ok = add_edges(g, merged_from, merged_to, sum);
+        } else {
+            perror("Falha ao alocar arestas de conflito");
+        }
+        arena_free(s->arena, merged_to);
+        arena_free(s->arena, merged_from);
+    }
+
+    // Ordem inversa da alocação, para a arena recuperar o que puder
+    for (int i = (shards && !sparse) ? threads - 1 : 0; i > 0; i--) free_graph(shards[i].local);
+    arena_free(s->arena, op_edges);
+    arena_free(s->arena, reader_next);
+    arena_free(s->arena, shards);
+    stats_add(STAT_EDGES, edges);
+    return ok;
+}
+
+// Percorre as operações no tempo, com a última escrita e os leitores desde
+// ela por atributo. Se g não for NULL, acrescenta as arestas de conflito;
+// se classes não for NULL, classifica o escalonamento pela mesma linha do
+// tempo de escritores e pelos commits. Retorna 0 em erro.
+static int scan_conflicts(Schedule* s, Graph* g, ScheduleClasses* classes) {
+    // As classes dependem da ordem dos commits entre atributos: só a
+    // passada serial as calcula
+    int threads = conflict_threads < s->attr_count ? conflict_threads : s->attr_count;
+    if (g && !classes && threads > 1 && s->op_count >= CONFLICT_SHARD_MIN_OPS) {
+        return shard_conflicts(s, g, threads);
+    }
+
+    // Índice de conflitos por atributo: para cada atributo guardamos o índice
+    // da última transação que o escreveu e a lista de leitores desde essa
+    // escrita. As arestas omitidas (escritas/leituras mais antigas) são
+    // implicadas por transitividade através da cadeia de escritores, então a
+    // existência de ciclo é a mesma do teste par a par.
+    int attrs = s->attr_count > 0 ? s->attr_count : 1;
+    int* last_writer = (int*)arena_alloc(s->arena, attrs * sizeof(int));
+    int* readers_head = (int*)arena_alloc(s->arena, attrs * sizeof(int));
+    int* reader_next = (int*)arena_alloc(s->arena, s->op_count * sizeof(int));
+    int ok = last_writer && readers_head && reader_next;
+
+    // Classes: transações já efetivadas e, por leitor, as leituras de
+    // escritas ainda não efetivadas (conferidas no commit do leitor)
+    unsigned char* committed = NULL;
+    int* dirty_head = NULL;
+    int* dirty_next = NULL;
+    int* dirty_writer = NULL;
+    if (ok && classes) {
+        committed = (unsigned char*)arena_calloc(s->arena, s->trans_count + 1, 1);
+        dirty_head = (int*)arena_alloc(s->arena, (s->trans_count + 1) * sizeof(int));
+        dirty_next = (int*)arena_alloc(s->arena, (s->op_count + 1) * sizeof(int));
+        dirty_writer = (int*)arena_alloc(s->arena, (s->op_count + 1) * sizeof(int));
+        ok = committed && dirty_head && dirty_next && dirty_writer;
+    }
+    if (!ok) {
+        perror("Falha ao alocar índice de conflitos");
+        arena_free(s->arena, dirty_writer);
+        arena_free(s->arena, dirty_next);
+        arena_free(s->arena, dirty_head);
+        arena_free(s->arena, committed);
+        arena_free(s->arena, reader_next);
+        arena_free(s->arena, readers_head);
+        arena_free(s->arena, last_writer);
+        return 0;
+    }
+    for (int a = 0; a < s->attr_count; a++) {
+        last_writer[a] = -1;
+        readers_head[a] = -1;
+    }
+    if (classes) {
+        *classes = (ScheduleClasses){1, 1, 1};
+        for (int t = 0; t < s->trans_count; t++) dirty_head[t] = -1;
+    }
+    long long edges = 0;
+
+    const int* col_trans = s->cols.trans;
+    const int* col_attr = s->cols.attr;
+    const unsigned char* col_kind = s->cols.kind;
+    for (int i = 0; ok && i < s->op_count; i++) {
+        int kind = col_kind[i];
+        int a = col_attr[i];
+        int t = col_trans[i];
+        if (kind == OP_COMMIT && classes) {
+            // RC: quem t leu precisa ter feito commit antes de t
+            committed[t] = 1;
+            for (int d = dirty_head[t]; d != -1; d = dirty_next[d]) {
+                if (!committed[dirty_writer[d]]) classes->recoverable = 0;
+            }
+            dirty_head[t] = -1;
+            continue;
+        }
+        if (kind > OP_WRITE || a == NO_ATTR) continue;
+
+        int w = last_writer[a];
+        if (w != -1 && w != t) {
+            // Última escrita -> operação atual (W-R e W-W)
+            if (g) {
+                ok = add_edge(g, w, t);
+                edges++;
+            }
+            if (classes && !committed[w]) {
+                // ST: ninguém toca o atributo antes do commit de quem o escreveu por último;
+                // ACA: ninguém lê uma escrita não efetivada
+                classes->strict = 0;
+                if (kind == OP_READ) {
+                    classes->cascadeless = 0;
+                    dirty_writer[i] = w;
+                    dirty_next[i] = dirty_head[t];
+                    dirty_head[t] = i;
+                }
+            }
+        }
+
+        if (kind == OP_READ) {
+            reader_next[i] = readers_head[a];
+            readers_head[a] = i;
+        } else {
+            // Leitores desde a última escrita -> escrita atual (R-W)
+            for (int r = readers_head[a]; g && ok && r != -1; r = reader_next[r]) {
+                if (col_trans[r] != t) {
+                    ok = add_edge(g, col_trans[r], t);
+                    edges++;
+                }
+            }
+            readers_head[a] = -1;
+            last_writer[a] = t;
+        }
+    }
+
+    arena_free(s->arena, dirty_writer);
+    arena_free(s->arena, dirty_next);
+    arena_free(s->arena, dirty_head);
+    arena_free(s->arena, committed);
+    arena_free(s->arena, reader_next);
+    arena_free(s->arena, readers_head);
+    arena_free(s->arena, last_writer);
+    stats_add(STAT_EDGES, edges);
+    return ok; // Grafo sem alguma aresta: erro, e não veredito
+}
+
+Graph* build_conflict_graph(Schedule* s) {
+    if (!schedule_columns(s)) return NULL;
+    Graph* g = create_graph_in(s->arena, s->trans_count, GRAPH_AUTO);
+    if (!g) return NULL;
+    if (!scan_conflicts(s, g, NULL)) {
+        free_graph(g);
+        return NULL;
+    }
+    return g;
+}
+
 int is_conflict_serializable(Schedule* s) {
     if (s->trans_count <= 1) return 1;
 
-    Graph* g = create_graph(s->trans_count);
-    if (!g) return 0; // Assume não serializável em caso de erro
+    ScheduleAnalysis a;
+    analysis_init(&a, s);
+    int result = analysis_conflict(&a);
+    analysis_free(&a);
+    return result;
+}
 
-    // Itera por todos os pares de operações para encontrar conflitos
-    for (int i = 0; i < s->op_count; i++) {
-        for (int j = i + 1; j < s->op_count; j++) {
-            Operation op1 = s->ops[i];
-            Operation op2 = s->ops[j];
+// conflict_order_or_cycle que, se classes não for NULL, também classifica o
+// escalonamento na mesma passada que constrói o grafo.
+static int conflict_evidence(Schedule* s, int* out, int* out_len, ScheduleClasses* classes) {
+    *out_len = 0;
+    if (s->trans_count <= 1) {
+        // Uma transação só não viola nenhuma das classes
+        if (classes) *classes = (ScheduleClasses){1, 1, 1};
+        for (int i = 0; i < s->trans_count; i++) out[(*out_len)++] = i;
+        return 1;
+    }
 
-            // Conflitos só ocorrem entre transações diferentes no mesmo atributo
-            if (op1.trans_id == op2.trans_id || op1.attr != op2.attr || op1.attr == '-') {
-                continue;
+    long long start = stats_clock();
+    Graph* g = NULL;
+    if (schedule_columns(s)) g = create_graph_in(s->arena, s->trans_count, GRAPH_AUTO);
+    if (g && !scan_conflicts(s, g, classes)) {
+        free_graph(g);
+        g = NULL;
+    }
+    start = stats_phase(STAT_GRAPH, start);
+    GraphWork* w = create_graph_work_in(s->arena, s->trans_count);
+    int result = (g && w) ? graph_order_or_cycle(g, w, out, out_len) : -1;
+    free_graph_work(w);
+    free_graph(g);
+    stats_phase(STAT_CYCLE, start);
+    if (result == -1) {
+        *out_len = 0;
+        return 0; // Assume não serializável em caso de erro
+    }
+    return !result;
+}
+
+int conflict_order_or_cycle(Schedule* s, int* out, int* out_len) {
+    return conflict_evidence(s, out, out_len, NULL);
+}
+
+// --- Tabelas de Equivalência por Visão ---
+
+// Índice de transação que representa o valor inicial no banco
+#define INITIAL_WRITER -1
+
+/**
+ * Tabelas pré-calculadas uma vez por escalonamento, a partir da linha do
+ * tempo de escritas de cada atributo. Com elas, testar uma ordem serial
+ * custa O(leituras + escritas) sem percorrer s->ops.
+ */
+struct ViewTables {
+    Arena* arena;
+    int trans_count;
+    int attr_count;
+    int read_count;
+    int* read_start;         // Leituras da transação t: [read_start[t], read_start[t + 1])
+    int* read_attr;          // Atributo lido (na ordem das operações de t)
+    int* read_writer;        // Escritor original da leitura (ou INITIAL_WRITER)
+    unsigned char* read_own; // 1 se t já escreveu o atributo antes desta leitura
+    int* final_writer;       // Escritor final de cada atributo (attr_count entradas)
+    int* write_start;        // Atributos escritos por t: [write_start[t], write_start[t + 1])
+    int* write_attr;         // Atributos distintos escritos (na ordem da primeira escrita)
+    int blind_writes;        // Alguma escrita cega ou repetida do mesmo atributo
+    int impossible;          // Alguma leitura que nenhum serial reproduz
+    int impossible_trans;    // A primeira delas: a transação e a posição em read_*
+    int impossible_read;
+};
+
+static void free_view_tables(ViewTables* vt) {
+    arena_free(vt->arena, vt->read_start);
+    arena_free(vt->arena, vt->read_attr);
+    arena_free(vt->arena, vt->read_writer);
+    arena_free(vt->arena, vt->read_own);
+    arena_free(vt->arena, vt->final_writer);
+    arena_free(vt->arena, vt->write_start);
+    arena_free(vt->arena, vt->write_attr);
+}
+
+// Monta as tabelas. Retorna 0 em erro.
+//
+// As marcas "t leu / escreveu o atributo a" são carimbos por atributo
+// (vetores de attr_count posições), válidos enquanto as operações de uma
+// mesma transação são percorridas juntas; por isso a passada por transação
+// usa as listas de operações por transação do escalonamento.
+static int build_view_tables(Schedule* s, ViewTables* vt) {
+    int n = s->trans_count;
+    int attrs = s->attr_count > 0 ? s->attr_count : 1;
+    Arena* arena = s->arena;
+    memset(vt, 0, sizeof(ViewTables));
+    vt->arena = arena;
+    vt->trans_count = n;
+    vt->attr_count = s->attr_count;
+    if (!schedule_ops_by_trans(s)) return 0;
+    const int* col_trans = s->cols.trans;
+    const int* col_attr = s->cols.attr;
+    const unsigned char* col_kind = s->cols.kind;
+    const int* by_trans = s->cols.by_trans;
+    const int* op_start = s->cols.by_trans_start;
+
+    vt->read_start = (int*)arena_calloc(arena, n + 1, sizeof(int));
+    vt->write_start = (int*)arena_calloc(arena, n + 1, sizeof(int));
+    vt->final_writer = (int*)arena_alloc(arena, attrs * sizeof(int));
+    int* cursor = (int*)arena_alloc(arena, (n + 1) * sizeof(int));
+    int* read_mark = (int*)arena_alloc(arena, attrs * sizeof(int));
+    int* write_mark = (int*)arena_alloc(arena, attrs * sizeof(int));
+    int ok = vt->read_start && vt->write_start && vt->final_writer && cursor && read_mark && write_mark;
+
+    // Contagem das leituras por transação
+    for (int i = 0; ok && i < s->op_count; i++) {
+        if (col_kind[i] == OP_READ && col_attr[i] != NO_ATTR) vt->read_start[col_trans[i] + 1]++;
+    }
+    for (int t = 0; ok && t < n; t++) {
+        vt->read_start[t + 1] += vt->read_start[t];
+    }
+    vt->read_count = ok ? vt->read_start[n] : 0;
+
+    int reads = vt->read_count > 0 ? vt->read_count : 1;
+    if (ok) {
+        vt->read_attr = (int*)arena_alloc(arena, reads * sizeof(int));
+        vt->read_writer = (int*)arena_alloc(arena, reads * sizeof(int));
+        vt->read_own = (unsigned char*)arena_alloc(arena, reads);
+        vt->write_attr = (int*)arena_alloc(arena, (s->op_count + 1) * sizeof(int));
+        ok = vt->read_attr && vt->read_writer && vt->read_own && vt->write_attr;
+    }
+    if (!ok) {
+        arena_free(arena, cursor);
+        arena_free(arena, read_mark);
+        arena_free(arena, write_mark);
+        free_view_tables(vt);
+        return 0;
+    }
+
+    // 1ª passada, por transação: leituras, conjuntos de escrita, escritas
+    // cegas ou repetidas e leituras da própria escrita
+    for (int a = 0; a < attrs; a++) {
+        read_mark[a] = -1;
+        write_mark[a] = -1;
+    }
+    int writes = 0;
+    for (int t = 0; t < n; t++) {
+        int r = vt->read_start[t];
+        vt->write_start[t] = writes;
+        for (int k = op_start[t]; k < op_start[t + 1]; k++) {
+            int i = by_trans[k];
+            int a = col_attr[i];
+            if (a == NO_ATTR) continue;
+            if (col_kind[i] == OP_READ) {
+                vt->read_attr[r] = a;
+                vt->read_own[r] = (unsigned char)(write_mark[a] == t);
+                r++;
+                read_mark[a] = t;
+            } else if (col_kind[i] == OP_WRITE) {
+                if (read_mark[a] != t || write_mark[a] == t) vt->blind_writes = 1;
+                if (write_mark[a] != t) vt->write_attr[writes++] = a;
+                write_mark[a] = t;
             }
+        }
+    }
+    vt->write_start[n] = writes;
 
-            // Pelo menos uma deve ser escrita (R-R não é conflito)
-            if (op1.op == 'W' || op2.op == 'W') {
-                int idx1 = get_trans_index(s, op1.trans_id);
-                int idx2 = get_trans_index(s, op2.trans_id);
-                add_edge(g, idx1, idx2);
+    // 2ª passada, no tempo: escritor original de cada leitura e escritor final
+    memcpy(cursor, vt->read_start, (n + 1) * sizeof(int)); // Próxima leitura de cada transação
+    for (int a = 0; a < s->attr_count; a++) {
+        vt->final_writer[a] = INITIAL_WRITER;
+    }
+    for (int i = 0; i < s->op_count; i++) {
+        int a = col_attr[i];
+        if (a == NO_ATTR) continue;
+        int t = col_trans[i];
+        if (col_kind[i] == OP_READ) {
+            int r = cursor[t]++;
+            vt->read_writer[r] = vt->final_writer[a];
+            // Em qualquer serial, t lê a própria escrita anterior
+            if (vt->read_own[r] && vt->read_writer[r] != t && !vt->impossible) {
+                vt->impossible = 1;
+                vt->impossible_trans = t;
+                vt->impossible_read = r;
             }
+        } else if (col_kind[i] == OP_WRITE) {
+            vt->final_writer[a] = t;
         }
     }
 
-    int has_cycle_result = has_cycle(g);
-    free_graph(g);
-    return !has_cycle_result;
+    arena_free(arena, cursor);
+    arena_free(arena, read_mark);
+    arena_free(arena, write_mark);
+    return 1;
 }
 
-// --- funcoes Auxiliares para Equivalência por Visão ---
+// --- Orçamento do Teste por Visão ---
+//
+// Cada teste por visão recebe um orçamento de passos e/ou de tempo (ver
+// set_view_search_budget). As buscas o consultam periodicamente; quando ele
+// acaba, param e descrevem onde estavam (ViewCheckpoint), para que uma
+// execução posterior continue dali.
+
+// Limites de cada teste (0 = sem limite).
+static long long view_budget_steps = 0;
+static long long view_budget_ns = 0;
+
+// Resultado interno das buscas interrompidas pelo orçamento.
+#define SEARCH_STOPPED 2
 
-// Estrutura para representar a relação "Lido-De" (Read-From)
 typedef struct {
-    int reader_trans_id;
-    int writer_trans_id;
-    char attr;
-} ReadFrom;
-
-// Encontra a última escrita de um atributo 'attr' antes do índice 'before_op_idx'
-int find_last_writer(Schedule* s, char attr, int before_op_idx) {
-    int last_writer_id = 0; // 0 representa o valor inicial no banco
-    for (int i = 0; i < before_op_idx; i++) {
-        if (s->ops[i].op == 'W' && s->ops[i].attr == attr) {
-            last_writer_id = s->ops[i].trans_id;
-        }
-    }
-    return last_writer_id;
-}
-
-// Encontra a última escrita de um atributo em um escalonamento serial
-int find_last_writer_serial(Schedule* s, const int* serial_order, int order_len, char attr) {
-     int last_writer_id = 0;
-     for (int i = 0; i < order_len; i++) {
-        int current_tid = serial_order[i];
-        for(int j = 0; j < s->op_count; j++) {
-            if(s->ops[j].trans_id == current_tid && s->ops[j].op == 'W' && s->ops[j].attr == attr) {
-                last_writer_id = current_tid;
-            }
+    atomic_llong steps_left;
+    long long deadline;      // Instante limite (ns, relógio monotônico), ou 0
+    atomic_int exhausted;
+} ViewBudget;
+
+// Contexto de uma busca do teste por visão.
+typedef struct {
+    ViewBudget budget;
+    const ViewCheckpoint* resume; // De onde retomar (NULL = do início)
+    ViewCheckpoint* stopped;      // Onde a busca parou (NULL = não interessa)
+    ViewWitness* witness;         // Evidência do resultado (NULL = não interessa)
+} ViewSearch;
+
+void set_view_search_budget(long long steps, long long timeout_ms) {
+    view_budget_steps = steps > 0 ? steps : 0;
+    view_budget_ns = timeout_ms > 0 ? timeout_ms * 1000000LL : 0;
+}
+
+static long long monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void budget_start(ViewBudget* b) {
+    atomic_init(&b->steps_left, view_budget_steps);
+    b->deadline = view_budget_ns ? monotonic_ns() + view_budget_ns : 0;
+    atomic_init(&b->exhausted, 0);
+}
+
+// Desconta 'steps' passos; retorna 0 se o orçamento acabou.
+static int budget_charge(ViewBudget* b, long long steps) {
+    if (atomic_load_explicit(&b->exhausted, memory_order_relaxed)) return 0;
+    if ((view_budget_steps && atomic_fetch_sub(&b->steps_left, steps) < steps) ||
+        (b->deadline && monotonic_ns() >= b->deadline)) {
+        atomic_store(&b->exhausted, 1);
+        return 0;
+    }
+    return 1;
+}
+
+// Guarda o ponto de parada de uma busca (na arena do escalonamento).
+static void record_stop(ViewSearch* vs, Arena* arena, ViewResumeKind kind, const int* path, int length) {
+    if (!vs->stopped) return;
+    int* copy = (int*)arena_alloc(arena, (length + 1) * sizeof(int));
+    if (!copy) return; // Sem ponto de parada: a próxima execução recomeça
+    memcpy(copy, path, length * sizeof(int));
+    *vs->stopped = (ViewCheckpoint){kind, length, copy};
+}
+
+// --- Enumeração de Permutações (paralela) ---
+//
+// As ordens seriais são geradas em ordem lexicográfica, uma posição por vez,
+// podando o prefixo assim que uma leitura da transação recém-colocada não lê
+// do escritor original, ou quando uma transação escreveria um atributo cujo
+// escritor final já foi colocado. Para paralelizar, o espaço é dividido
+// pelos prefixos das primeiras k posições: cada thread pega o próximo
+// prefixo livre de um contador compartilhado. A primeira ordem encontrada no
+// menor prefixo é a lexicograficamente menor, o que mantém o resultado
+// determinístico independentemente do número de threads.
+
+// Número de threads da busca por permutações (ver set_view_search_threads).
+static int view_search_threads = 1;
+
+// Prefixos por thread desejados, para equilibrar a carga entre as threads.
+#define PERM_TASKS_PER_THREAD 16
+
+// Intervalo de passos entre verificações do sinal de cancelamento.
+#define PERM_CANCEL_CHECK 1024
+
+void set_view_search_threads(int threads) {
+    view_search_threads = (threads > 0) ? threads : 1;
+}
+
+// Estado compartilhado entre as threads de uma busca.
+typedef struct {
+    const ViewTables* vt;
+    int prefix_len;          // k: posições fixadas por tarefa
+    long long task_count;    // n! / (n - k)! prefixos
+    atomic_llong next_task;  // Próximo prefixo a ser pego
+    atomic_llong best_task;  // Menor prefixo com solução (task_count se nenhum)
+    pthread_mutex_t lock;
+    int* best_order;
+    ViewBudget* budget;
+    long long check_every;   // Passos entre verificações (menor com orçamento pequeno)
+    const int* resume;       // Caminho de retomada (transações), ou NULL
+    int resume_len;
+    long long resume_task;   // Prefixo que contém o caminho de retomada
+} PermShared;
+
+// Estado de uma thread: o prefixo atual e como desfazê-lo.
+typedef struct {
+    PermShared* shared;
+    int* order;
+    unsigned char* placed;
+    int* last;                // Último escritor de cada atributo no prefixo
+    int* undo;                // Pilha de (atributo, escritor anterior)
+    int undo_top;
+    long long task;
+    long long steps;
+    long long pruned;         // Extensões recusadas por perm_place
+    int cancelled;
+    int resume_len;           // Níveis do caminho de retomada ainda a seguir
+    int stopped;              // O orçamento acabou durante o prefixo stop_task
+    int stop_len;             // ...e a busca parou em order[0..stop_len)
+    long long stop_task;
+} PermWorker;
+
+// Coloca t na próxima posição; retorna 0 (sem alterar nada) se o prefixo fica inválido.
+static int perm_place(PermWorker* w, int t) {
+    const ViewTables* vt = w->shared->vt;
+    for (int r = vt->read_start[t]; r < vt->read_start[t + 1]; r++) {
+        if (!vt->read_own[r] && w->last[vt->read_attr[r]] != vt->read_writer[r]) return 0;
+    }
+    for (int k = vt->write_start[t]; k < vt->write_start[t + 1]; k++) {
+        int fw = vt->final_writer[vt->write_attr[k]];
+        if (fw != t && w->placed[fw]) return 0; // Sobrescreveria a escrita final
+    }
+    for (int k = vt->write_start[t]; k < vt->write_start[t + 1]; k++) {
+        int a = vt->write_attr[k];
+        w->undo[w->undo_top++] = a;
+        w->undo[w->undo_top++] = w->last[a];
+        w->last[a] = t;
+    }
+    w->placed[t] = 1;
+    return 1;
+}
+
+static void perm_unplace(PermWorker* w, int t) {
+    const ViewTables* vt = w->shared->vt;
+    int written = vt->write_start[t + 1] - vt->write_start[t];
+    while (written-- > 0) {
+        w->undo_top -= 2;
+        w->last[w->undo[w->undo_top]] = w->undo[w->undo_top + 1];
+    }
+    w->placed[t] = 0;
+}
+
+// Completa o prefixo de tamanho 'depth' em ordem lexicográfica.
+// Com todas as posições preenchidas, as escritas finais já estão corretas:
+// nenhum escritor foi colocado depois do escritor final do atributo.
+static int perm_search(PermWorker* w, int depth) {
+    int n = w->shared->vt->trans_count;
+    if (depth == n) return 1;
+
+    if (++w->steps % w->shared->check_every == 0) {
+        if (atomic_load(&w->shared->best_task) < w->task) {
+            w->cancelled = 1; // Um prefixo menor já tem solução
+        } else if (!budget_charge(w->shared->budget, w->shared->check_every)) {
+            // Nada a partir deste prefixo foi explorado ainda
+            w->cancelled = 1;
+            w->stopped = 1;
+            w->stop_len = depth;
         }
-     }
-     return last_writer_id;
+    }
+    if (w->cancelled) return 0;
+
+    // Na retomada, o primeiro ramo de cada nível segue o caminho salvo
+    int first = (w->resume_len > depth) ? w->shared->resume[depth] : 0;
+    for (int t = first; t < n; t++) {
+        if (t > first) w->resume_len = 0;
+        if (w->placed[t]) continue;
+        if (!perm_place(w, t)) {
+            w->pruned++;
+            continue;
+        }
+        w->order[depth] = t;
+        if (perm_search(w, depth + 1)) return 1;
+        perm_unplace(w, t);
+        if (w->cancelled) return 0;
+    }
+    return 0;
 }
 
+// Quantidade de prefixos de tamanho k por escolha na posição p: (n-p-1)! / (n-k)!
+static long long prefix_block(int n, int k, int p) {
+    long long block = 1;
+    for (int i = n - k + 1; i <= n - p - 1; i++) block *= i;
+    return block;
+}
 
-// Compara as escritas finais entre o escalonamento original e um serial
-int compare_final_writes(Schedule* s, const int* serial_order, int order_len) {
-    char processed_attrs[26] = {0}; // Assumindo atributos de 'A' a 'Z'
-    for (int i = 0; i < s->op_count; i++) {
-        char attr = s->ops[i].attr;
-        if (attr != '-' && !processed_attrs[attr - 'A']) {
-            int original_final_writer = find_last_writer(s, attr, s->op_count);
-            int serial_final_writer = find_last_writer_serial(s, serial_order, order_len, attr);
-            if(original_final_writer != serial_final_writer) {
-                return 0;
+// Decodifica o prefixo de índice 'task' em out[0..k), sem validá-lo.
+static void decode_prefix(int n, int k, long long task, unsigned char* used, int* out) {
+    for (int t = 0; t < n; t++) used[t] = 0;
+    for (int p = 0; p < k; p++) {
+        long long block = prefix_block(n, k, p);
+        long long digit = task / block;
+        task %= block;
+        int t = 0;
+        for (;; t++) {
+            if (!used[t] && digit-- == 0) break;
+        }
+        used[t] = 1;
+        out[p] = t;
+    }
+}
+
+// Índice do primeiro prefixo de tamanho k que não vem antes de path[0..len).
+static long long encode_prefix(int n, int k, const int* path, int len, unsigned char* used) {
+    long long task = 0;
+    for (int t = 0; t < n; t++) used[t] = 0;
+    for (int p = 0; p < k && p < len; p++) {
+        int digit = 0;
+        for (int t = 0; t < path[p]; t++) digit += !used[t];
+        used[path[p]] = 1;
+        task += digit * prefix_block(n, k, p);
+    }
+    return task;
+}
+
+// Decodifica o prefixo de índice 'task' (ordem lexicográfica) e o coloca.
+// Retorna 0 se o prefixo já é inválido.
+static int perm_place_prefix(PermWorker* w, long long task) {
+    int n = w->shared->vt->trans_count;
+    int k = w->shared->prefix_len;
+    for (int p = 0; p < k; p++) {
+        long long block = prefix_block(n, k, p);
+        long long digit = task / block;
+        task %= block;
+
+        int t = 0;
+        for (;; t++) {
+            if (!w->placed[t] && digit-- == 0) break;
+        }
+        if (!perm_place(w, t)) return 0;
+        w->order[p] = t;
+    }
+    return 1;
+}
+
+static void* perm_worker_run(void* arg) {
+    PermWorker* w = (PermWorker*)arg;
+    PermShared* sh = w->shared;
+    int n = sh->vt->trans_count;
+
+    for (;;) {
+        long long task = atomic_fetch_add(&sh->next_task, 1);
+        if (task >= sh->task_count || task > atomic_load(&sh->best_task)) break;
+        if (atomic_load(&sh->budget->exhausted)) {
+            // O orçamento acabou antes deste prefixo: a retomada começa nele
+            w->stopped = 1;
+            w->stop_task = task;
+            w->stop_len = sh->prefix_len;
+            decode_prefix(n, sh->prefix_len, task, w->placed, w->order);
+            break;
+        }
+
+        // Recomeça do prefixo vazio
+        for (int t = 0; t < n; t++) w->placed[t] = 0;
+        for (int a = 0; a < sh->vt->attr_count; a++) w->last[a] = INITIAL_WRITER;
+        w->undo_top = 0;
+        w->task = task;
+        w->cancelled = 0;
+        w->resume_len = (sh->resume && task == sh->resume_task) ? sh->resume_len : 0;
+
+        if (!perm_place_prefix(w, task) || !perm_search(w, sh->prefix_len)) {
+            if (!w->stopped) continue;
+            w->stop_task = task;
+            break;
+        }
+
+        pthread_mutex_lock(&sh->lock);
+        if (task < atomic_load(&sh->best_task)) {
+            atomic_store(&sh->best_task, task);
+            memcpy(sh->best_order, w->order, n * sizeof(int));
+        }
+        pthread_mutex_unlock(&sh->lock);
+    }
+    return NULL;
+}
+
+static int init_perm_worker(PermWorker* w, PermShared* sh) {
+    const ViewTables* vt = sh->vt;
+    int total_writes = vt->write_start[vt->trans_count];
+    w->shared = sh;
+    w->steps = 0;
+    w->pruned = 0;
+    w->stopped = 0;
+    w->order = (int*)arena_alloc(vt->arena, vt->trans_count * sizeof(int));
+    w->placed = (unsigned char*)arena_alloc(vt->arena, vt->trans_count);
+    w->undo = (int*)arena_alloc(vt->arena, (2 * total_writes + 1) * sizeof(int));
+    w->last = (int*)arena_alloc(vt->arena, (vt->attr_count + 1) * sizeof(int));
+    return w->order && w->placed && w->undo && w->last;
+}
+
+static void free_perm_worker(PermWorker* w) {
+    Arena* arena = w->shared->vt->arena;
+    arena_free(arena, w->order);
+    arena_free(arena, w->placed);
+    arena_free(arena, w->undo);
+    arena_free(arena, w->last);
+}
+
+/**
+ * @brief Procura, entre as permutações, a menor ordem serial equivalente por visão.
+ *
+ * Se o orçamento acabar antes, guarda em vs->stopped o menor prefixo ainda
+ * não explorado. Uma solução achada antes disso continua valendo, mas pode
+ * não ser a lexicograficamente menor.
+ *
+ * @param vt As tabelas de visão do escalonamento.
+ * @param order Recebe a ordem encontrada (índices densos).
+ * @param vs Orçamento e pontos de retomada/parada.
+ * @return 1 se encontrou, 0 se não existe, SEARCH_STOPPED se o orçamento
+ *         acabou, -1 em erro.
+ */
+static int search_permutations(const ViewTables* vt, int* order, ViewSearch* vs) {
+    int n = vt->trans_count;
+    int threads = view_search_threads;
+    if (threads > n) threads = n;
+    if (threads < 1) threads = 1;
+
+    PermShared sh;
+    sh.vt = vt;
+    sh.best_order = order;
+    sh.prefix_len = 0;
+    sh.task_count = 1;
+    // Menor k com prefixos suficientes para todas as threads
+    while (threads > 1 && sh.prefix_len < n &&
+           sh.task_count < (long long)threads * PERM_TASKS_PER_THREAD) {
+        sh.task_count *= n - sh.prefix_len;
+        sh.prefix_len++;
+    }
+    sh.budget = &vs->budget;
+    // Um orçamento menor que o intervalo acabaria sem nunca ser cobrado
+    sh.check_every = PERM_CANCEL_CHECK;
+    if (view_budget_steps && view_budget_steps < sh.check_every) sh.check_every = view_budget_steps;
+    sh.resume = NULL;
+    sh.resume_len = 0;
+    sh.resume_task = 0;
+    if (vs->resume && vs->resume->kind == VIEW_RESUME_PERMUTATION) {
+        // Os prefixos anteriores ao da retomada já foram descartados
+        unsigned char* used = (unsigned char*)arena_alloc(vt->arena, n + 1);
+        if (used) {
+            sh.resume = vs->resume->path;
+            sh.resume_len = vs->resume->length;
+            sh.resume_task = encode_prefix(n, sh.prefix_len, sh.resume, sh.resume_len, used);
+        }
+        arena_free(vt->arena, used);
+    }
+    atomic_init(&sh.next_task, sh.resume_task);
+    atomic_init(&sh.best_task, sh.task_count);
+    pthread_mutex_init(&sh.lock, NULL);
+
+    PermWorker* workers = (PermWorker*)arena_calloc(vt->arena, threads, sizeof(PermWorker));
+    pthread_t* tids = (pthread_t*)arena_alloc(vt->arena, threads * sizeof(pthread_t));
+    int ok = workers && tids;
+    for (int i = 0; ok && i < threads; i++) {
+        ok = init_perm_worker(&workers[i], &sh);
+    }
+
+    if (ok) {
+        // A thread atual também trabalha: cria apenas threads - 1 novas
+        int started = 1;
+        for (int i = 1; i < threads; i++, started++) {
+            if (pthread_create(&tids[i], NULL, perm_worker_run, &workers[i]) != 0) break;
+        }
+        perm_worker_run(&workers[0]);
+        for (int i = 1; i < started; i++) {
+            pthread_join(tids[i], NULL);
+        }
+    }
+
+    // Com o orçamento esgotado, a retomada começa no menor prefixo interrompido
+    int found = atomic_load(&sh.best_task) < sh.task_count;
+    PermWorker* first_stop = NULL;
+    for (int i = 0; workers && i < threads; i++) {
+        PermWorker* w = &workers[i];
+        if (w->shared && w->stopped && (!first_stop || w->stop_task < first_stop->stop_task)) first_stop = w;
+    }
+    if (!found && first_stop) {
+        record_stop(vs, vt->arena, VIEW_RESUME_PERMUTATION, first_stop->order, first_stop->stop_len);
+    }
+
+    for (int i = 0; workers && i < threads; i++) {
+        if (!workers[i].shared) continue;
+        stats_add(STAT_PERMS_TRIED, workers[i].steps);
+        stats_add(STAT_PERMS_PRUNED, workers[i].pruned);
+        free_perm_worker(&workers[i]);
+    }
+    arena_free(vt->arena, workers);
+    arena_free(vt->arena, tids);
+    pthread_mutex_destroy(&sh.lock);
+
+    if (!ok) return -1;
+    return found ? 1 : first_stop ? SEARCH_STOPPED : 0;
+}
+
+// --- Busca por Polígrafo (Equivalência por Visão) ---
+//
+// Um escalonamento serial S é equivalente por visão ao original se cada
+// leitura lê do mesmo escritor e cada atributo tem o mesmo escritor final.
+// Isso vira um polígrafo sobre as transações mais dois nós artificiais: INIT
+// (escreve o valor inicial de tudo, vem antes de todos) e FINAL (lê o valor
+// final de tudo, vem depois de todos). Cada leitura de x por Tj que lê de Ti
+// força a aresta Ti -> Tj, e cada outro escritor Tk de x precisa ficar fora
+// do intervalo: Tk -> Ti ou Tj -> Tk. Quando um dos lados é INIT ou FINAL a
+// escolha é forçada; as demais são resolvidas por backtracking, propagando
+// as escolhas que ficam forçadas e podando ao primeiro ciclo.
+
+// Uma escolha do polígrafo: aresta (writer -> source) ou (reader -> writer).
+typedef struct {
+    int writer;
+    int source;
+    int reader;
+} PolyChoice;
+
+// Um nível da pilha de decisões do backtracking.
+typedef struct {
+    int choice;
+    int option; // 0: writer -> source, 1: reader -> writer
+    int edge_mark;
+    int resolved_mark;
+} PolyDecision;
+
+typedef struct {
+    Arena* arena;
+    int num_nodes;
+    // Arestas em listas encadeadas por origem; inseridas e removidas em pilha
+    int* head;
+    int* edge_from;
+    int* edge_to;
+    int* edge_next;
+    int edge_count;
+    int edge_capacity;
+    // Escolhas pendentes e a pilha das já resolvidas (para desfazer)
+    PolyChoice* choices;
+    int choice_count;
+    int choice_capacity;
+    unsigned char* resolved;
+    int* resolved_stack;
+    int resolved_count;
+    // Busca de alcançabilidade
+    int* mark;
+    int mark_stamp;
+    int* dfs_stack;
+} Polygraph;
+
+static void free_polygraph(Polygraph* p) {
+    arena_free(p->arena, p->head);
+    arena_free(p->arena, p->edge_from);
+    arena_free(p->arena, p->edge_to);
+    arena_free(p->arena, p->edge_next);
+    arena_free(p->arena, p->choices);
+    arena_free(p->arena, p->resolved);
+    arena_free(p->arena, p->resolved_stack);
+    arena_free(p->arena, p->mark);
+    arena_free(p->arena, p->dfs_stack);
+}
+
+static int init_polygraph(Polygraph* p, Arena* arena, int num_nodes) {
+    memset(p, 0, sizeof(Polygraph));
+    p->arena = arena;
+    p->num_nodes = num_nodes;
+    p->head = (int*)arena_alloc(arena, num_nodes * sizeof(int));
+    p->mark = (int*)arena_calloc(arena, num_nodes, sizeof(int));
+    p->dfs_stack = (int*)arena_alloc(arena, num_nodes * sizeof(int));
+    if (!p->head || !p->mark || !p->dfs_stack) {
+        free_polygraph(p);
+        return 0;
+    }
+    for (int i = 0; i < num_nodes; i++) p->head[i] = -1;
+    return 1;
+}
+
+// Verifica se 'to' é alcançável a partir de 'from' pelas arestas atuais.
+static int poly_reaches(Polygraph* p, int from, int to) {
+    if (from == to) return 1;
+    p->mark_stamp++;
+    int top = 0;
+    p->dfs_stack[top++] = from;
+    p->mark[from] = p->mark_stamp;
+    while (top > 0) {
+        int u = p->dfs_stack[--top];
+        for (int e = p->head[u]; e != -1; e = p->edge_next[e]) {
+            int v = p->edge_to[e];
+            if (v == to) return 1;
+            if (p->mark[v] != p->mark_stamp) {
+                p->mark[v] = p->mark_stamp;
+                p->dfs_stack[top++] = v;
             }
-            processed_attrs[attr - 'A'] = 1;
         }
     }
+    return 0;
+}
+
+// Insere a aresta from -> to; retorna 0 se ela fecharia um ciclo, -1 em erro.
+static int poly_add_edge(Polygraph* p, int from, int to) {
+    if (poly_reaches(p, from, to)) return 1; // Já implicada, nada a fazer
+    if (poly_reaches(p, to, from)) return 0;
+
+    if (p->edge_count >= p->edge_capacity) {
+        int cap = p->edge_capacity ? p->edge_capacity * 2 : 64;
+        size_t old_size = p->edge_capacity * sizeof(int);
+        int* f = (int*)arena_realloc(p->arena, p->edge_from, old_size, cap * sizeof(int));
+        if (f) p->edge_from = f;
+        int* t = (int*)arena_realloc(p->arena, p->edge_to, old_size, cap * sizeof(int));
+        if (t) p->edge_to = t;
+        int* n = (int*)arena_realloc(p->arena, p->edge_next, old_size, cap * sizeof(int));
+        if (n) p->edge_next = n;
+        if (!f || !t || !n) return -1;
+        p->edge_capacity = cap;
+    }
+    int e = p->edge_count++;
+    p->edge_from[e] = from;
+    p->edge_to[e] = to;
+    p->edge_next[e] = p->head[from];
+    p->head[from] = e;
     return 1;
 }
 
+static int poly_add_choice(Polygraph* p, int writer, int source, int reader) {
+    if (p->choice_count >= p->choice_capacity) {
+        int cap = p->choice_capacity ? p->choice_capacity * 2 : 64;
+        PolyChoice* c = (PolyChoice*)arena_realloc(p->arena, p->choices, p->choice_capacity * sizeof(PolyChoice),
+                                                   cap * sizeof(PolyChoice));
+        if (!c) return 0;
+        p->choices = c;
+        p->choice_capacity = cap;
+    }
+    p->choices[p->choice_count++] = (PolyChoice){writer, source, reader};
+    return 1;
+}
 
-int compare_read_from(Schedule* s, const int* serial_order, int order_len) {
-    for (int i = 0; i < s->op_count; i++) {
-        if (s->ops[i].op == 'R') {
-            Operation read_op = s->ops[i];
-            
-            // Relação no escalonamento original
-            int original_writer = find_last_writer(s, read_op.attr, i);
-
-            // Relação no escalonamento serial
-            int serial_writer = 0; 
-            int reader_pos = -1;
-
-            for(int j = 0; j < order_len; j++) {
-                if(serial_order[j] == read_op.trans_id) reader_pos = j;
+// Desfaz arestas e escolhas resolvidas até as marcas indicadas.
+static void poly_undo(Polygraph* p, int edge_mark, int resolved_mark) {
+    while (p->edge_count > edge_mark) {
+        int e = --p->edge_count;
+        p->head[p->edge_from[e]] = p->edge_next[e];
+    }
+    while (p->resolved_count > resolved_mark) {
+        p->resolved[p->resolved_stack[--p->resolved_count]] = 0;
+    }
+}
+
+static void poly_resolve(Polygraph* p, int c) {
+    p->resolved[c] = 1;
+    p->resolved_stack[p->resolved_count++] = c;
+}
+
+// Aplica a opção escolhida de c; retorna 0 se ela fecha um ciclo, -1 em erro.
+static int poly_apply(Polygraph* p, int c, int option) {
+    PolyChoice ch = p->choices[c];
+    poly_resolve(p, c);
+    return option == 0 ? poly_add_edge(p, ch.writer, ch.source)
+                       : poly_add_edge(p, ch.reader, ch.writer);
+}
+
+// Resolve as escolhas já satisfeitas ou forçadas até um ponto fixo.
+// Retorna 1 se consistente, 0 em contradição, -1 em erro.
+static int poly_propagate(Polygraph* p) {
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int c = 0; c < p->choice_count; c++) {
+            if (p->resolved[c]) continue;
+            PolyChoice ch = p->choices[c];
+            if (poly_reaches(p, ch.writer, ch.source) || poly_reaches(p, ch.reader, ch.writer)) {
+                poly_resolve(p, c); // Já satisfeita por alguma das arestas
+                continue;
             }
+            int ok0 = !poly_reaches(p, ch.source, ch.writer);
+            int ok1 = !poly_reaches(p, ch.writer, ch.reader);
+            if (!ok0 && !ok1) return 0;
+            if (ok0 && ok1) continue;
+            int r = poly_apply(p, c, ok0 ? 0 : 1);
+            if (r != 1) return r;
+            changed = 1;
+        }
+    }
+    return 1;
+}
+
+// Ordem topológica (Kahn) das transações, sem os nós INIT e FINAL.
+static void poly_topological_order(Polygraph* p, int n, int* order) {
+    int* indeg = p->mark; // Reaproveita o vetor de marcas
+    int* queue = p->dfs_stack;
+    for (int u = 0; u < p->num_nodes; u++) indeg[u] = 0;
+    for (int e = 0; e < p->edge_count; e++) indeg[p->edge_to[e]]++;
 
-            for(int j = 0; j < reader_pos; j++) {
-                int current_tid = serial_order[j];
-                 for(int k = 0; k < s->op_count; k++) {
-                    if (s->ops[k].trans_id == current_tid && s->ops[k].op == 'W' && s->ops[k].attr == read_op.attr) {
-                        serial_writer = current_tid;
-                    }
+    int qh = 0, qt = 0, len = 0;
+    for (int u = 0; u < p->num_nodes; u++) {
+        if (indeg[u] == 0) queue[qt++] = u;
+    }
+    while (qh < qt) {
+        int u = queue[qh++];
+        if (u < n) order[len++] = u;
+        for (int e = p->head[u]; e != -1; e = p->edge_next[e]) {
+            if (--indeg[p->edge_to[e]] == 0) queue[qt++] = p->edge_to[e];
+        }
+    }
+    p->mark_stamp = 0;
+    for (int u = 0; u < p->num_nodes; u++) p->mark[u] = 0;
+}
+
+// Guarda a restrição cuja aresta fechou um ciclo do polígrafo.
+static void poly_witness(ViewWitness* witness, ViewWitnessKind kind, int trans, int attr, int other) {
+    if (witness) *witness = (ViewWitness){kind, NULL, trans, attr, other};
+}
+
+// Monta as arestas forçadas e as escolhas do polígrafo a partir das tabelas.
+// Retorna 1 se consistente, 0 se já contraditório (com a restrição violada
+// em witness, se não for NULL), -1 em erro.
+static int build_polygraph(const ViewTables* vt, Polygraph* p, ViewWitness* witness) {
+    int n = vt->trans_count;
+    int init = n;
+    int final = n + 1;
+    int result = 1;
+
+    // Por atributo, a lista de transações que o escrevem (em ordem crescente),
+    // transpondo os conjuntos de escrita por ordenação por contagem
+    int attrs = vt->attr_count;
+    int count = vt->write_start[n];
+    int* writers_start = (int*)arena_calloc(p->arena, attrs + 2, sizeof(int));
+    int* writer_list = (int*)arena_alloc(p->arena, (count + 1) * sizeof(int));
+    if (!writers_start || !writer_list) {
+        arena_free(p->arena, writers_start);
+        arena_free(p->arena, writer_list);
+        return -1;
+    }
+    for (int k = 0; k < count; k++) writers_start[vt->write_attr[k] + 2]++;
+    for (int a = 0; a < attrs; a++) writers_start[a + 2] += writers_start[a + 1];
+    for (int t = 0; t < n; t++) {
+        for (int k = vt->write_start[t]; k < vt->write_start[t + 1]; k++) {
+            writer_list[writers_start[vt->write_attr[k] + 1]++] = t;
+        }
+    }
+
+    for (int t = 0; t < n && result == 1; t++) {
+        result = poly_add_edge(p, init, t);
+        if (result == 1) result = poly_add_edge(p, t, final);
+    }
+
+    // Restrições de leitura
+    for (int r = 0; r < n && result == 1; r++) {
+        for (int i = vt->read_start[r]; i < vt->read_start[r + 1] && result == 1; i++) {
+            if (vt->read_own[i]) continue; // Já validadas em 'impossible'
+            int a = vt->read_attr[i];
+            int src = (vt->read_writer[i] == INITIAL_WRITER) ? init : vt->read_writer[i];
+            result = poly_add_edge(p, src, r);
+            for (int k = writers_start[a]; k < writers_start[a + 1] && result == 1; k++) {
+                int w = writer_list[k];
+                if (w == src || w == r) continue;
+                if (src == init) {
+                    result = poly_add_edge(p, r, w);
+                } else if (!poly_add_choice(p, w, src, r)) {
+                    result = -1;
                 }
             }
+            if (result == 0) poly_witness(witness, VIEW_WITNESS_READ, r, a, vt->read_writer[i]);
+        }
+    }
 
-            if (original_writer != serial_writer) {
-                return 0;
-            }
+    // Restrições de escrita final: o último escritor vem depois dos demais
+    for (int a = 0; a < attrs && result == 1; a++) {
+        int fw = vt->final_writer[a];
+        if (fw == INITIAL_WRITER) continue;
+        for (int k = writers_start[a]; k < writers_start[a + 1] && result == 1; k++) {
+            if (writer_list[k] != fw) result = poly_add_edge(p, writer_list[k], fw);
+            if (result == 0) poly_witness(witness, VIEW_WITNESS_FINAL_WRITE, writer_list[k], a, fw);
         }
     }
-    return 1;
+
+    arena_free(p->arena, writers_start);
+    arena_free(p->arena, writer_list);
+    return result;
+}
+
+// Limite inferior de log2(n!), usado para comparar os espaços de busca.
+static int log2_factorial_floor(int n) {
+    int bits = 0;
+    for (int i = 2; i <= n; i++) bits += 31 - __builtin_clz((unsigned int)i);
+    return bits;
+}
+
+/**
+ * @brief Procura um escalonamento serial equivalente por visão via polígrafo.
+ * @param vt As tabelas de visão do escalonamento.
+ * @param order Recebe a ordem serial encontrada (índices densos).
+ * @param fallback Recebe 1 se restam mais escolhas abertas do que log2(n!),
+ *        caso em que a enumeração de permutações é o espaço menor.
+ * @param vs Orçamento e pontos de retomada/parada.
+ * @return 1 se encontrou, 0 se não existe, SEARCH_STOPPED se o orçamento
+ *         acabou, -1 em erro ou fallback.
+ */
+static int polygraph_search(const ViewTables* vt, int* order, int* fallback, ViewSearch* vs) {
+    Polygraph p;
+    int n = vt->trans_count;
+    *fallback = 0;
+    if (!init_polygraph(&p, vt->arena, n + 2)) return -1;
+
+    int result = build_polygraph(vt, &p, vs->witness);
+    if (result == 1) {
+        p.resolved = (unsigned char*)arena_calloc(p.arena, p.choice_count + 1, 1);
+        p.resolved_stack = (int*)arena_alloc(p.arena, (p.choice_count + 1) * sizeof(int));
+        if (!p.resolved || !p.resolved_stack) result = -1;
+    }
+    if (result == 1) result = poly_propagate(&p);
+
+    if (result == 1) {
+        int open = 0;
+        for (int c = 0; c < p.choice_count; c++) open += !p.resolved[c];
+        if (open > log2_factorial_floor(n)) {
+            *fallback = 1;
+            free_polygraph(&p);
+            return -1;
+        }
+    }
+
+    PolyDecision* decisions = NULL;
+    int* options = NULL;
+    int depth = 0;
+    if (result == 1) {
+        decisions = (PolyDecision*)arena_alloc(p.arena, (p.choice_count + 1) * sizeof(PolyDecision));
+        options = (int*)arena_alloc(p.arena, (p.choice_count + 1) * sizeof(int));
+        if (!decisions || !options) result = -1;
+    }
+
+    // Retomada: refaz as decisões do ponto de parada anterior. A busca é
+    // determinística, então o estado reconstruído é o mesmo de antes.
+    if (result == 1 && vs->resume && vs->resume->kind == VIEW_RESUME_POLYGRAPH) {
+        for (int i = 0; i < vs->resume->length && result == 1; i++) {
+            int c = 0;
+            while (c < p.choice_count && p.resolved[c]) c++;
+            if (c == p.choice_count) break;
+            int option = vs->resume->path[i] != 0;
+            decisions[depth++] = (PolyDecision){c, option, p.edge_count, p.resolved_count};
+            result = poly_apply(&p, c, option);
+            if (result == 1) result = poly_propagate(&p);
+        }
+    }
+
+    // Backtracking: 'result' é o estado após a última decisão/propagação
+    while (result != -1) {
+        int c = 0;
+        if (result == 1) {
+            while (c < p.choice_count && p.resolved[c]) c++;
+            if (c == p.choice_count) break; // Todas resolvidas: achou
+        } else {
+            // Contradição: volta à decisão mais recente que ainda tem alternativa
+            while (depth > 0 && decisions[depth - 1].option == 1) depth--;
+            if (depth == 0) break; // Espaço esgotado: não existe
+        }
+
+        if (!budget_charge(&vs->budget, 1)) {
+            // O ponto de parada é a pilha de decisões (a do topo ainda por trocar)
+            for (int i = 0; i < depth; i++) options[i] = decisions[i].option;
+            record_stop(vs, vt->arena, VIEW_RESUME_POLYGRAPH, options, depth);
+            result = SEARCH_STOPPED;
+            break;
+        }
+
+        if (result == 1) {
+            decisions[depth] = (PolyDecision){c, 0, p.edge_count, p.resolved_count};
+            depth++;
+            stats_add(STAT_POLY_DECISIONS, 1);
+            result = poly_apply(&p, c, 0);
+        } else {
+            PolyDecision* d = &decisions[depth - 1];
+            poly_undo(&p, d->edge_mark, d->resolved_mark);
+            d->option = 1;
+            stats_add(STAT_POLY_BACKTRACKS, 1);
+            result = poly_apply(&p, d->choice, 1);
+        }
+        if (result == 1) result = poly_propagate(&p);
+    }
+
+    if (result == 1) poly_topological_order(&p, n, order);
+
+    arena_free(p.arena, options);
+    arena_free(p.arena, decisions);
+    free_polygraph(&p);
+    return result;
 }
 
+// --- Algoritmo de Seriabilidade por Visão ---
 
-// Função para trocar dois inteiros
-void swap(int* a, int* b) {
-    int temp = *a;
-    *a = *b;
-    *b = temp;
+// Confere se o ponto de retomada cabe neste escalonamento.
+static int valid_checkpoint(const ViewCheckpoint* c, int n) {
+    if (c->kind == VIEW_RESUME_POLYGRAPH) return c->length >= 0;
+    if (c->kind != VIEW_RESUME_PERMUTATION || c->length < 0 || c->length > n) return 0;
+    for (int i = 0; i < c->length; i++) {
+        if (c->path[i] < 0 || c->path[i] >= n) return 0;
+        for (int j = 0; j < i; j++) {
+            if (c->path[j] == c->path[i]) return 0;
+        }
+    }
+    return 1;
 }
 
-// Função recursiva para gerar e testar permutações
-int check_all_permutations(Schedule* s, int* arr, int start, int end) {
-    if (start == end) {
-        // Uma permutação (escalonamento serial) foi gerada. Testá-la.
-        if (compare_final_writes(s, arr, end + 1) && compare_read_from(s, arr, end + 1)) {
-            return 1;
+// Teste por visão de um escalonamento que não é serializável por conflito.
+static int view_search(Schedule* s, const ViewTables* vt, ViewSearch* vs) {
+    // Teorema: sem escritas cegas (nem repetidas), serializável por visão
+    // equivale a por conflito.
+    if (!vt->blind_writes || vt->impossible) {
+        if (vs->witness && vt->impossible) {
+            int r = vt->impossible_read;
+            poly_witness(vs->witness, VIEW_WITNESS_READ, vt->impossible_trans, vt->read_attr[r], vt->read_writer[r]);
+        } else if (vs->witness) {
+            vs->witness->kind = VIEW_WITNESS_CONFLICT;
         }
         return 0;
     }
-    for (int i = start; i <= end; i++) {
-        swap((arr + start), (arr + i));
-        if (check_all_permutations(s, arr, start + 1, end)) {
-            return 1;
+
+    // Com escritas cegas, resolve as restrições do polígrafo por backtracking.
+    int* order = (int*)arena_alloc(s->arena, s->trans_count * sizeof(int));
+    if (!order) return 0;
+
+    int fallback;
+    int result = polygraph_search(vt, order, &fallback, vs);
+    if (result == -1 && fallback) {
+        // Escolhas demais em aberto: testamos as permutações seriais (de índices densos).
+        result = search_permutations(vt, order, vs);
+    }
+
+    if (vs->witness && result == 1) {
+        *vs->witness = (ViewWitness){VIEW_WITNESS_ORDER, order, -1, NO_ATTR, -1};
+    } else {
+        if (vs->witness && result == 0 && vs->witness->kind == VIEW_WITNESS_NONE) {
+            vs->witness->kind = VIEW_WITNESS_SEARCH;
         }
-        swap((arr + start), (arr + i)); // Backtrack
+        arena_free(s->arena, order);
     }
-    return 0;
+    if (result == SEARCH_STOPPED) return VIEW_UNKNOWN;
+    return result == 1;
 }
 
-// --- Algoritmo de Seriabilidade por Visão ---
+// --- Análise Compartilhada ---
+
+void analysis_init(ScheduleAnalysis* a, Schedule* s) {
+    a->s = s;
+    a->conflict = -1;
+    a->evidence = NULL;
+    a->evidence_len = 0;
+    a->view_tables = NULL;
+    a->want_classes = 0;
+    a->classes_done = 0;
+
+    // Visões do formato binário já trazem as transações remapeadas
+    if (!s->trans_ids) {
+        long long start = stats_clock();
+        find_unique_transactions(s);
+        stats_phase(STAT_UNIQUE, start);
+    }
+}
+
+int analysis_conflict(ScheduleAnalysis* a) {
+    if (a->conflict != -1) return a->conflict;
+    Schedule* s = a->s;
+    a->evidence = (int*)arena_alloc(s->arena, (s->trans_count + 1) * sizeof(int));
+    if (!a->evidence) {
+        perror("Falha ao alocar ordem do grafo de precedência");
+        a->conflict = 0; // Assume não serializável em caso de erro
+        return 0;
+    }
+    // Com want_classes, a classificação sai da mesma passada do grafo
+    ScheduleClasses* classes = (a->want_classes && !a->classes_done) ? &a->classes : NULL;
+    a->conflict = conflict_evidence(s, a->evidence, &a->evidence_len, classes);
+    if (classes) a->classes_done = 1;
+    return a->conflict;
+}
+
+const ScheduleClasses* analysis_classes(ScheduleAnalysis* a) {
+    if (a->classes_done) return &a->classes;
+    if (a->conflict == -1) {
+        a->want_classes = 1;
+        analysis_conflict(a);
+        // Sem memória para a evidência, a passada não aconteceu
+        if (a->classes_done) return &a->classes;
+    }
+    // Grafo já construído: só a classificação, sem as arestas
+    if (!schedule_columns(a->s) || !scan_conflicts(a->s, NULL, &a->classes)) return NULL;
+    a->classes_done = 1;
+    return &a->classes;
+}
+
+// Tabelas de visão da análise, montadas na primeira chamada. NULL em erro.
+static const ViewTables* analysis_view_tables(ScheduleAnalysis* a) {
+    if (a->view_tables) return a->view_tables;
+    ViewTables* vt = (ViewTables*)arena_alloc(a->s->arena, sizeof(ViewTables));
+    if (!vt) return NULL;
+    if (!build_view_tables(a->s, vt)) {
+        arena_free(a->s->arena, vt);
+        return NULL;
+    }
+    a->view_tables = vt;
+    return vt;
+}
+
+int analysis_view(ScheduleAnalysis* a, const ViewCheckpoint* resume, ViewCheckpoint* stopped, ViewWitness* witness) {
+    Schedule* s = a->s;
+    if (stopped) *stopped = (ViewCheckpoint){VIEW_RESUME_NONE, 0, NULL};
+    if (witness) *witness = (ViewWitness){VIEW_WITNESS_NONE, NULL, -1, NO_ATTR, -1};
 
-int is_view_serializable(Schedule* s) {
     // Teorema: Todo escalonamento serializável por conflito é também serializável por visão.
-    if (is_conflict_serializable(s)) {
+    // A ordem topológica do grafo de precedência já é uma ordem serial.
+    if (analysis_conflict(a)) {
+        if (witness) *witness = (ViewWitness){VIEW_WITNESS_ORDER, a->evidence, -1, NO_ATTR, -1};
         return 1;
     }
 
-    // Se não for serializável por conflito, pode ser por visão (ex: com escritas cegas).
-    // Testamos a equivalência com todas as permutações seriais.
-    int* trans_ids_copy = (int*)malloc(s->trans_count * sizeof(int));
-    if (!trans_ids_copy) return 0;
-    
-    memcpy(trans_ids_copy, s->trans_ids, s->trans_count * sizeof(int));
+    long long start = stats_clock();
+    const ViewTables* vt = analysis_view_tables(a);
+    if (!vt) {
+        stats_phase(STAT_VIEW, start);
+        return 0;
+    }
+    ViewSearch vs;
+    budget_start(&vs.budget);
+    vs.resume = (resume && valid_checkpoint(resume, s->trans_count)) ? resume : NULL;
+    vs.stopped = stopped;
+    vs.witness = witness;
+    int result = view_search(s, vt, &vs);
+    stats_phase(STAT_VIEW, start);
+    return result;
+}
 
-    int result = check_all_permutations(s, trans_ids_copy, 0, s->trans_count - 1);
+void analysis_free(ScheduleAnalysis* a) {
+    if (a->view_tables) {
+        free_view_tables(a->view_tables);
+        arena_free(a->s->arena, a->view_tables);
+        a->view_tables = NULL;
+    }
+    arena_free(a->s->arena, a->evidence);
+    a->evidence = NULL;
+    a->conflict = -1;
+    a->classes_done = 0;
+}
 
-    free(trans_ids_copy);
+int view_verdict(Schedule* s, const ViewCheckpoint* resume, ViewCheckpoint* stopped, ViewWitness* witness) {
+    ScheduleAnalysis a;
+    analysis_init(&a, s);
+    int result = analysis_view(&a, resume, stopped, witness);
+    // A ordem vinda do teste por conflito passa a pertencer ao chamador
+    if (witness && witness->order == a.evidence) a.evidence = NULL;
+    analysis_free(&a);
     return result;
 }
+
+int is_view_serializable(Schedule* s) {
+    return view_verdict(s, NULL, NULL, NULL) == 1;
+}
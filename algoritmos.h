@@ -9,6 +9,10 @@
 #ifndef ALGORITMOS_H
 #define ALGORITMOS_H
 
+#include "arena.h"
+#include "atributos.h"
+#include "grafo.h"
+
 /**
  * @struct Operation
  * @brief Representa uma unica operação em uma transacao.
@@ -16,10 +20,41 @@
 typedef struct {
     int time; // timestamp da operação.
     int trans_id; // ID da transação que pertence.
+    int trans_idx; // Índice denso da transação (posição em Schedule::trans_ids).
+    int attr; // ID global do atributo acessado (ver atributos.h), ou NO_ATTR.
+    int attr_idx; // Índice denso do atributo no escalonamento (0..attr_count-1), ou NO_ATTR.
     char op; // Tipo de operação (R, W, C).
-    char attr; // Atributo (item de dado) sendo acessado.
 } Operation;
 
+/**
+ * @brief Tipo de operação nas colunas do escalonamento (um byte por operação).
+ */
+typedef enum {
+    OP_READ,
+    OP_WRITE,
+    OP_COMMIT,
+    OP_OTHER
+} OpKind;
+
+/**
+ * @struct OpColumns
+ * @brief As operações em colunas, só com os campos que os testes leem.
+ *
+ * Os laços dos algoritmos percorrem apenas as colunas de que precisam, sem
+ * arrastar o tempo e os IDs globais de Operation por cada linha de cache.
+ * As listas de operações por transação e por atributo (índices em ordem de
+ * tempo, no formato CSR) são montadas só quando algum teste as pede.
+ */
+typedef struct {
+    int* trans;            // Índice denso da transação de cada operação
+    int* attr;             // Índice denso do atributo (ou NO_ATTR)
+    unsigned char* kind;   // OpKind
+    int* by_trans_start;   // Operações da transação t: by_trans[by_trans_start[t] .. by_trans_start[t + 1])
+    int* by_trans;
+    int* by_attr_start;    // Operações do atributo a: by_attr[by_attr_start[a] .. by_attr_start[a + 1])
+    int* by_attr;
+} OpColumns;
+
 /**
  * @struct Schedule
  * @brief Representa um escalonamento completo de operacoes.
@@ -30,16 +65,126 @@ typedef struct {
     int op_capacity; // Capacidade atual do array de operacoes.
     int* trans_ids; // Array com os IDs únicos das transacoes.
     int trans_count; // Número de transacoes únicas.
+    int attr_count; // Número de atributos distintos (índices densos).
+    int owns_data; // 0 se ops e trans_ids apontam para memória externa (ex.: arquivo mapeado).
+    Arena* arena; // Arena de onde saem o Schedule e os dados dos algoritmos (NULL = heap).
+    OpColumns cols; // Colunas das operações (ver schedule_columns); sempre do escalonamento.
 } Schedule;
 
+// Resultado de view_verdict quando o orçamento acaba antes da resposta.
+#define VIEW_UNKNOWN -1
+
+/**
+ * @brief Busca do teste por visão a que um ponto de parada se refere.
+ */
+typedef enum {
+    VIEW_RESUME_NONE,        // Sem ponto de parada
+    VIEW_RESUME_POLYGRAPH,   // Backtracking do polígrafo
+    VIEW_RESUME_PERMUTATION  // Enumeração de permutações
+} ViewResumeKind;
+
+/**
+ * @struct ViewCheckpoint
+ * @brief Onde a busca do teste por visão parou quando o orçamento acabou.
+ *
+ * Tudo o que vem antes do ponto (na ordem de exploração) já foi descartado.
+ * No polígrafo, path guarda a opção (0 ou 1) de cada decisão na pilha; nas
+ * permutações, o prefixo de transações (índices densos) a partir do qual a
+ * enumeração continua.
+ */
+typedef struct {
+    ViewResumeKind kind;
+    int length;
+    int* path;
+} ViewCheckpoint;
+
+/**
+ * @brief Evidência do resultado do teste por visão (ver view_verdict).
+ */
+typedef enum {
+    VIEW_WITNESS_NONE,        // Sem evidência (resultado desconhecido ou erro)
+    VIEW_WITNESS_ORDER,       // Serializável: order é uma ordem serial equivalente
+    VIEW_WITNESS_CONFLICT,    // Sem escritas cegas: o ciclo do grafo de precedência basta
+    VIEW_WITNESS_READ,        // Nenhum serial faz trans ler attr de other
+    VIEW_WITNESS_FINAL_WRITE, // Nenhum serial põe trans, que escreve attr, antes do escritor final other
+    VIEW_WITNESS_SEARCH       // Nenhuma ordem satisfaz todas as restrições juntas
+} ViewWitnessKind;
+
+/**
+ * @struct ViewWitness
+ * @brief Ordem serial ou restrição violada que justifica o veredito por visão.
+ *
+ * Transações e atributos são índices densos (posições em
+ * Schedule::trans_ids e Operation::attr_idx). Em VIEW_WITNESS_READ, other
+ * vale -1 quando a leitura original é do valor inicial.
+ */
+typedef struct {
+    ViewWitnessKind kind;
+    int* order;  // trans_count elementos (na arena do escalonamento)
+    int trans;
+    int attr;
+    int other;
+} ViewWitness;
+
+/**
+ * @struct ViewTables
+ * @brief Tabelas de leituras e escritas do teste por visão (opaco).
+ */
+typedef struct ViewTables ViewTables;
+
+/**
+ * @struct ScheduleClasses
+ * @brief Classes de recuperação do escalonamento (1 = pertence à classe).
+ */
+typedef struct {
+    int recoverable;  // RC: cada transação faz commit depois das que escreveram o que ela leu
+    int cascadeless;  // ACA: só se lê escrita já efetivada (evita abortos em cascata)
+    int strict;       // ST: ninguém lê nem escreve um atributo antes do commit de quem o escreveu por último
+} ScheduleClasses;
+
+/**
+ * @struct ScheduleAnalysis
+ * @brief Resultados intermediários compartilhados pelos testes de um escalonamento.
+ *
+ * Cada artefato (índices densos, veredito por conflito com a ordem ou o
+ * ciclo do grafo de precedência, tabelas de leituras e escritas) é
+ * calculado na primeira vez que um teste precisa dele e reaproveitado
+ * pelos demais: o teste por visão parte do veredito por conflito já
+ * calculado, em vez de construir o grafo de novo.
+ */
+typedef struct {
+    Schedule* s;
+    int conflict;             // Veredito por conflito (-1 = ainda não calculado)
+    int* evidence;            // Ordem topológica (serializável) ou ciclo, em índices densos
+    int evidence_len;
+    ViewTables* view_tables;  // NULL = ainda não montadas
+    int want_classes;         // Classificar na passada do teste por conflito (ver analysis_classes)
+    int classes_done;
+    ScheduleClasses classes;
+} ScheduleAnalysis;
+
 /**
  * @brief Cria e inicializa uma nova estrutura de escalonamento.
  * @return Ponteiro para o Schedule criado ou NULL em caso de erro.
  */
 Schedule* create_schedule();
 
+/**
+ * @brief Cria um escalonamento cujas alocações saem de uma arena.
+ *
+ * O grafo e os vetores de trabalho dos testes também são alocados nessa
+ * arena; zerá-la (arena_reset) descarta o escalonamento inteiro.
+ *
+ * @param arena A arena, ou NULL para usar o heap (igual a create_schedule).
+ * @return Ponteiro para o Schedule criado ou NULL em caso de erro.
+ */
+Schedule* create_schedule_in(Arena* arena);
+
 /**
  * @brief Libera toda a memoria associada a um escalonamento.
+ *
+ * Em visões (owns_data == 0), libera apenas a estrutura.
+ *
  * @param s O escalonamento a ser liberado.
  */
 void free_schedule(Schedule* s);
@@ -50,16 +195,116 @@ void free_schedule(Schedule* s);
  * @param time O tempo de chegada.
  * @param trans_id O ID da transação.
  * @param op O tipo de operação.
- * @param attr O atributo.
+ * @param attr O ID global do atributo, ou NO_ATTR.
  */
-void add_operation(Schedule* s, int time, int trans_id, char op, char attr);
+void add_operation(Schedule* s, int time, int trans_id, char op, int attr);
 
 /**
  * @brief Encontra e armazena os IDs únicos de transação do escalonamento.
+ *
+ * Também remapeia cada trans_id para um índice denso (0..trans_count-1, na
+ * ordem crescente dos IDs) e o grava em Operation::trans_idx, de modo que os
+ * algoritmos trabalhem apenas com índices. Da mesma forma, remapeia os
+ * IDs globais de atributo para índices densos (na ordem de primeira
+ * aparição) em Operation::attr_idx e preenche attr_count; as estruturas por
+ * atributo dos testes são vetores desse tamanho.
+ *
  * @param s O escalonamento a ser analisado.
  */
 void find_unique_transactions(Schedule* s);
 
+/**
+ * @brief Monta as colunas do escalonamento (s->cols), se ainda não existem.
+ * @param s O escalonamento (com find_unique_transactions já chamado).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int schedule_columns(Schedule* s);
+
+/**
+ * @brief Monta as listas de operações por transação (s->cols.by_trans).
+ * @param s O escalonamento (com find_unique_transactions já chamado).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int schedule_ops_by_trans(Schedule* s);
+
+/**
+ * @brief Monta as listas de operações por atributo (s->cols.by_attr).
+ *
+ * As operações sem atributo (commits) ficam de fora.
+ *
+ * @param s O escalonamento (com find_unique_transactions já chamado).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int schedule_ops_by_attr(Schedule* s);
+
+/**
+ * @brief Constrói o grafo de precedência do escalonamento.
+ *
+ * Os vértices são os índices densos das transações. O grafo sai da arena do
+ * escalonamento e deve ser liberado com free_graph.
+ *
+ * @param s O escalonamento (com find_unique_transactions já chamado).
+ * @return O grafo, ou NULL em caso de falha de alocação.
+ */
+Graph* build_conflict_graph(Schedule* s);
+
+/**
+ * @brief Começa a análise de um escalonamento.
+ *
+ * Chama find_unique_transactions, se ainda não foi chamada. Os demais
+ * artefatos saem da arena do escalonamento à medida que são pedidos.
+ *
+ * @param a A análise.
+ * @param s O escalonamento.
+ */
+void analysis_init(ScheduleAnalysis* a, Schedule* s);
+
+/**
+ * @brief Veredito por conflito, calculado uma única vez por análise.
+ *
+ * Depois da chamada, a->evidence guarda a ordem topológica do grafo de
+ * precedência (se serializável) ou as transações de um ciclo.
+ *
+ * @param a A análise.
+ * @return 1 se for serializável por conflito e 0 caso contrario.
+ */
+int analysis_conflict(ScheduleAnalysis* a);
+
+/**
+ * @brief Classes de recuperação do escalonamento (RC, ACA e ST).
+ *
+ * Saem da mesma passada que constrói o grafo de precedência, pela linha do
+ * tempo de escritores por atributo e pelos commits: marque a->want_classes
+ * antes de analysis_conflict, ou chame esta função primeiro. Depois do
+ * teste por conflito, custam uma passada só de classificação.
+ *
+ * @param a A análise.
+ * @return As classes (dentro da análise), ou NULL em falha de alocação.
+ */
+const ScheduleClasses* analysis_classes(ScheduleAnalysis* a);
+
+/**
+ * @brief Teste por visão sobre a análise (ver view_verdict).
+ *
+ * Usa o veredito por conflito da análise (calculando-o, se preciso) e as
+ * tabelas de visão, montadas só quando o escalonamento não é serializável
+ * por conflito. Em VIEW_WITNESS_ORDER a partir do teste por conflito,
+ * witness->order aponta para a->evidence.
+ *
+ * @param a A análise.
+ * @param resume Ponto de onde retomar, ou NULL para começar do início.
+ * @param stopped Recebe o ponto de parada, ou NULL.
+ * @param witness Recebe a evidência do resultado, ou NULL.
+ * @return 1 se serializável por visão, 0 se não, VIEW_UNKNOWN se o orçamento acabou.
+ */
+int analysis_view(ScheduleAnalysis* a, const ViewCheckpoint* resume, ViewCheckpoint* stopped, ViewWitness* witness);
+
+/**
+ * @brief Libera os artefatos da análise (não o escalonamento).
+ * @param a A análise.
+ */
+void analysis_free(ScheduleAnalysis* a);
+
 /**
  * @brief Testa se o escalonamento é serializável por conflito.
  *
@@ -70,15 +315,97 @@ void find_unique_transactions(Schedule* s);
  */
 int is_conflict_serializable(Schedule* s);
 
+/**
+ * @brief Testa a seriabilidade por conflito e devolve a evidência do resultado.
+ *
+ * Se o escalonamento for serializável, out recebe uma ordem topológica do
+ * grafo de precedência (o escalonamento serial equivalente); caso contrário,
+ * recebe as transações de um ciclo, na ordem das arestas. Os elementos de out
+ * são índices densos (posições em Schedule::trans_ids).
+ *
+ * @param s O escalonamento a ser testado.
+ * @param out Vetor de saída com espaço para trans_count elementos.
+ * @param out_len Recebe o número de elementos escritos em out.
+ * @return 1 se for serializável por conflito e 0 caso contrario.
+ */
+int conflict_order_or_cycle(Schedule* s, int* out, int* out_len);
+
 /**
  * @brief Testa se o escalonamento é serializável por visão.
  *
- * Compara o escalonamento original com todas as possíveis permutações
- * de escalonamentos seriais formados pelas mesmas transações.
+ * Resolve as restrições de leitura e escrita final como um polígrafo e,
+ * quando há escolhas demais em aberto, enumera as permutações seriais (em
+ * paralelo, ver set_view_search_threads).
+ *
+ * Sem orçamento (o padrão), a busca sempre termina; com orçamento, um
+ * resultado desconhecido conta como 0 (ver view_verdict).
  *
  * @param s O escalonamento a ser testado.
  * @return 1 se for equivalente por visão a algum escalonamento serial e 0 caso contrario.
  */
 int is_view_serializable(Schedule* s);
 
+/**
+ * @brief Teste por visão com orçamento e retomada.
+ *
+ * Igual a is_view_serializable, mas respeita o orçamento de
+ * set_view_search_budget: se ele acabar antes da resposta, devolve
+ * VIEW_UNKNOWN e, se stopped não for NULL, o ponto onde a busca parou.
+ * Passar esse ponto em resume, numa execução posterior sobre o mesmo
+ * escalonamento, continua a busca dali em vez de recomeçá-la.
+ *
+ * @param s O escalonamento a ser testado.
+ * @param resume Ponto de onde retomar, ou NULL para começar do início.
+ * @param stopped Recebe o ponto de parada (path alocado na arena do
+ *        escalonamento), ou kind VIEW_RESUME_NONE se a busca terminou. Pode ser NULL.
+ * @param witness Recebe a evidência do resultado, ou NULL se não interessa.
+ * @return 1 se serializável por visão, 0 se não, VIEW_UNKNOWN se o orçamento acabou.
+ */
+int view_verdict(Schedule* s, const ViewCheckpoint* resume, ViewCheckpoint* stopped, ViewWitness* witness);
+
+/**
+ * @brief Define o orçamento de cada teste por visão.
+ *
+ * Os passos são as decisões do polígrafo e os prefixos estendidos na
+ * enumeração de permutações (conferidos a cada 1024). Deve ser chamada
+ * antes de iniciar as análises.
+ *
+ * @param steps Máximo de passos por teste (0 = sem limite).
+ * @param timeout_ms Tempo máximo por teste, em milissegundos (0 = sem limite).
+ */
+void set_view_search_budget(long long steps, long long timeout_ms);
+
+/**
+ * @brief Define o número de threads da enumeração de permutações do teste por visão.
+ *
+ * O resultado não depende do número de threads: a ordem serial escolhida é
+ * sempre a lexicograficamente menor.
+ *
+ * @param threads Número de threads (valores menores que 1 equivalem a 1).
+ */
+void set_view_search_threads(int threads);
+
+/**
+ * @brief Número de operações a partir do qual as arestas de conflito de um
+ * escalonamento são geradas em paralelo, por faixas de atributos (ver
+ * set_conflict_threads). Abaixo disso, criar as threads custa mais que a
+ * passada serial.
+ */
+#ifndef CONFLICT_SHARD_MIN_OPS
+#define CONFLICT_SHARD_MIN_OPS 65536
+#endif
+
+/**
+ * @brief Define o número de threads da geração das arestas de conflito.
+ *
+ * Num escalonamento com pelo menos CONFLICT_SHARD_MIN_OPS operações, os
+ * atributos são divididos em faixas com números parecidos de operações e
+ * cada thread gera as arestas da sua faixa. O grafo resultante é o mesmo da
+ * passada serial, com as arestas na mesma ordem, então os vereditos e as
+ * ordens/ciclos de conflict_order_or_cycle não dependem do número de threads.
+ *
+ * @param threads Número de threads (valores menores que 1 equivalem a 1).
+ */
+void set_conflict_threads(int threads);
+
 #endif // ALGORITMOS_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @file arena.c
+ * @brief Implementação do alocador em arena.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "arena.h"
+
+// Tamanho padrão de um bloco.
+#define ARENA_DEFAULT_BLOCK (64 * 1024)
+
+// Alinhamento de todas as alocações.
+#define ARENA_ALIGN 16
+
+static atomic_long heap_calls = 0;
+static _Thread_local long thread_heap_calls = 0;
+
+static void count_heap_call(void) {
+    atomic_fetch_add_explicit(&heap_calls, 1, memory_order_relaxed);
+    thread_heap_calls++;
+}
+
+long arena_heap_calls(void) {
+    return atomic_load(&heap_calls);
+}
+
+long arena_thread_heap_calls(void) {
+    return thread_heap_calls;
+}
+
+static size_t align_up(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+Arena* arena_create(size_t block_size) {
+    count_heap_call();
+    Arena* a = (Arena*)calloc(1, sizeof(Arena));
+    if (!a) {
+        perror("Falha ao alocar arena");
+        return NULL;
+    }
+    a->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK;
+    return a;
+}
+
+void arena_destroy(Arena* a) {
+    if (!a) return;
+    ArenaBlock* b = a->first;
+    while (b) {
+        ArenaBlock* next = b->next;
+        count_heap_call();
+        free(b);
+        b = next;
+    }
+    count_heap_call();
+    free(a);
+}
+
+void arena_reset(Arena* a) {
+    // Os blocos seguintes são zerados quando a alocação chegar a eles
+    a->current = a->first;
+    if (a->current) a->current->used = 0;
+    a->last_alloc = NULL;
+}
+
+// Avança para um bloco com pelo menos 'size' bytes livres, criando-o se preciso.
+static ArenaBlock* arena_block_for(Arena* a, size_t size) {
+    ArenaBlock* b = a->current;
+    if (b && b->size - b->used >= size) return b;
+
+    // Reaproveita os blocos seguintes que já existem
+    ArenaBlock* prev = b;
+    ArenaBlock* next = b ? b->next : a->first;
+    while (next) {
+        next->used = 0;
+        if (next->size >= size) {
+            a->current = next;
+            return next;
+        }
+        prev = next;
+        next = next->next;
+    }
+
+    size_t data_size = size > a->block_size ? size : a->block_size;
+    count_heap_call();
+    ArenaBlock* nb = (ArenaBlock*)malloc(align_up(sizeof(ArenaBlock)) + data_size);
+    if (!nb) {
+        perror("Falha ao alocar bloco da arena");
+        return NULL;
+    }
+    nb->next = NULL;
+    nb->size = data_size;
+    nb->used = 0;
+    nb->data = (char*)nb + align_up(sizeof(ArenaBlock));
+    if (prev) {
+        prev->next = nb;
+    } else {
+        a->first = nb;
+    }
+    a->current = nb;
+    return nb;
+}
+
+void* arena_alloc(Arena* a, size_t size) {
+    if (!a) {
+        count_heap_call();
+        return malloc(size ? size : 1);
+    }
+    size = align_up(size ? size : 1);
+    ArenaBlock* b = arena_block_for(a, size);
+    if (!b) return NULL;
+    void* p = b->data + b->used;
+    b->used += size;
+    a->last_alloc = p;
+    return p;
+}
+
+void* arena_calloc(Arena* a, size_t count, size_t size) {
+    if (!a) {
+        count_heap_call();
+        return calloc(count ? count : 1, size ? size : 1);
+    }
+    // Como calloc: count * size que não cabe em size_t é falha, não um bloco curto
+    if (size && count > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void* p = arena_alloc(a, count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+void* arena_realloc(Arena* a, void* p, size_t old_size, size_t new_size) {
+    if (!a) {
+        count_heap_call();
+        return realloc(p, new_size ? new_size : 1);
+    }
+    if (!p) return arena_alloc(a, new_size);
+
+    // A última alocação pode crescer (ou encolher) no próprio bloco
+    ArenaBlock* b = a->current;
+    if (p == a->last_alloc) {
+        size_t start = (size_t)((char*)p - b->data);
+        size_t need = align_up(new_size ? new_size : 1);
+        if (start + need <= b->size) {
+            b->used = start + need;
+            return p;
+        }
+    }
+    if (new_size <= old_size) return p;
+
+    void* np = arena_alloc(a, new_size);
+    if (np) memcpy(np, p, old_size);
+    return np;
+}
+
+void arena_free(Arena* a, void* p) {
+    if (a || !p) return;
+    count_heap_call();
+    free(p);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file arena.h
+ * @brief Alocador em arena para os dados de cada escalonamento.
+ *
+ * Todas as alocações de um escalonamento (o próprio Schedule, o grafo e os
+ * vetores de trabalho dos algoritmos) saem de uma arena, que é zerada em
+ * O(1) entre escalonamentos. Os blocos da arena são mantidos, então depois
+ * do aquecimento o processamento não faz mais chamadas ao heap.
+ *
+ * As funções aceitam arena NULL: nesse caso usam malloc/free diretamente.
+ * Toda chamada ao heap feita por aqui é contada (ver arena_heap_calls).
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @struct ArenaBlock
+ * @brief Bloco de memória de uma arena (lista encadeada).
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;  // Bytes úteis em data
+    size_t used;  // Bytes já entregues
+    char* data;
+} ArenaBlock;
+
+/**
+ * @struct Arena
+ * @brief Uma arena: os blocos e a posição atual de alocação.
+ * @var Arena::first Primeiro bloco da lista.
+ * @var Arena::current Bloco de onde saem as próximas alocações.
+ * @var Arena::block_size Tamanho mínimo de um bloco novo.
+ * @var Arena::last_alloc Última alocação feita, que pode crescer no lugar.
+ */
+typedef struct {
+    ArenaBlock* first;
+    ArenaBlock* current;
+    size_t block_size;
+    void* last_alloc;
+} Arena;
+
+/**
+ * @brief Cria uma arena vazia.
+ * @param block_size Tamanho mínimo de cada bloco (0 para o padrão).
+ * @return A arena criada, ou NULL em caso de falha.
+ */
+Arena* arena_create(size_t block_size);
+
+/**
+ * @brief Libera a arena e todos os seus blocos.
+ * @param a A arena.
+ */
+void arena_destroy(Arena* a);
+
+/**
+ * @brief Descarta todas as alocações da arena em O(1), mantendo os blocos.
+ * @param a A arena.
+ */
+void arena_reset(Arena* a);
+
+/**
+ * @brief Aloca size bytes alinhados a 16 bytes.
+ * @param a A arena, ou NULL para usar malloc.
+ * @param size O número de bytes.
+ * @return O ponteiro alocado, ou NULL em caso de falha.
+ */
+void* arena_alloc(Arena* a, size_t size);
+
+/**
+ * @brief Aloca count * size bytes zerados.
+ * @param a A arena, ou NULL para usar calloc.
+ * @param count Número de elementos.
+ * @param size Tamanho de cada elemento.
+ * @return O ponteiro alocado, ou NULL em caso de falha.
+ */
+void* arena_calloc(Arena* a, size_t count, size_t size);
+
+/**
+ * @brief Redimensiona uma alocação.
+ *
+ * Se p for a última alocação da arena e houver espaço no bloco, cresce no
+ * lugar; caso contrário, copia para uma alocação nova (a antiga só é
+ * recuperada no próximo arena_reset).
+ *
+ * @param a A arena, ou NULL para usar realloc.
+ * @param p A alocação atual (pode ser NULL).
+ * @param old_size O tamanho atual de p.
+ * @param new_size O novo tamanho.
+ * @return O ponteiro redimensionado, ou NULL em caso de falha (p continua válido).
+ */
+void* arena_realloc(Arena* a, void* p, size_t old_size, size_t new_size);
+
+/**
+ * @brief Libera uma alocação: no-op em arenas, free quando a é NULL.
+ * @param a A arena, ou NULL.
+ * @param p A alocação.
+ */
+void arena_free(Arena* a, void* p);
+
+/**
+ * @brief Total de chamadas ao heap feitas por este módulo, em todas as threads.
+ * @return O número de chamadas a malloc, calloc, realloc e free.
+ */
+long arena_heap_calls(void);
+
+/**
+ * @brief Chamadas ao heap feitas por este módulo na thread atual.
+ * @return O número de chamadas a malloc, calloc, realloc e free.
+ */
+long arena_thread_heap_calls(void);
+
+#endif // ARENA_H
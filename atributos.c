@@ -0,0 +1,187 @@
+/**
+ * @file atributos.c
+ * @brief Implementação da tabela de nomes de atributos.
+ *
+ * Os nomes ficam concatenados (com '\0') em blocos que nunca mudam de
+ * lugar; a tabela hash guarda apenas IDs, e cada ID aponta para o seu nome.
+ * Só a leitura que registra nomes novos altera a tabela; attr_name pode ser
+ * chamada de outras threads (as análises do modo em lote), por isso o vetor
+ * de nomes só cresce ou recebe um ID novo com o lock tomado.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "atributos.h"
+
+// Tamanho mínimo de um bloco de nomes.
+#define NAME_BLOCK_SIZE (64 * 1024)
+
+typedef struct NameBlock {
+    struct NameBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} NameBlock;
+
+struct AttrTable {
+    int* slots;         // IDs (ou -1), sondagem linear
+    uint32_t* hashes;   // Hash do nome de cada ID, para crescer sem recalcular
+    const char** names; // Nome de cada ID, dentro de um bloco
+    int count;
+    int capacity;       // Capacidade de hashes/names
+    size_t mask;        // Tamanho de slots - 1
+    NameBlock* blocks;  // Bloco atual (o primeiro da lista)
+    pthread_mutex_t lock;
+};
+
+// FNV-1a de 32 bits.
+static uint32_t hash_name(const char* name, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+AttrTable* attr_table_create(void) {
+    AttrTable* t = (AttrTable*)calloc(1, sizeof(AttrTable));
+    if (!t) {
+        perror("Falha ao alocar tabela de atributos");
+        return NULL;
+    }
+    t->mask = 63;
+    t->slots = (int*)malloc((t->mask + 1) * sizeof(int));
+    if (!t->slots) {
+        perror("Falha ao alocar tabela de atributos");
+        free(t);
+        return NULL;
+    }
+    memset(t->slots, -1, (t->mask + 1) * sizeof(int));
+    pthread_mutex_init(&t->lock, NULL);
+    return t;
+}
+
+void attr_table_free(AttrTable* t) {
+    if (!t) return;
+    while (t->blocks) {
+        NameBlock* next = t->blocks->next;
+        free(t->blocks);
+        t->blocks = next;
+    }
+    free(t->slots);
+    free(t->hashes);
+    free(t->names);
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+}
+
+void attr_table_clear(AttrTable* t) {
+    // Fica só com o bloco atual, vazio
+    while (t->blocks && t->blocks->next) {
+        NameBlock* next = t->blocks->next;
+        t->blocks->next = next->next;
+        free(next);
+    }
+    if (t->blocks) t->blocks->used = 0;
+    memset(t->slots, -1, (t->mask + 1) * sizeof(int));
+    pthread_mutex_lock(&t->lock);
+    t->count = 0;
+    pthread_mutex_unlock(&t->lock);
+}
+
+int attr_table_count(const AttrTable* t) {
+    return t->count;
+}
+
+const char* attr_name(const AttrTable* t, int id) {
+    if (id < 0) return "-";
+    pthread_mutex_lock((pthread_mutex_t*)&t->lock);
+    const char* name = (id < t->count) ? t->names[id] : "-";
+    pthread_mutex_unlock((pthread_mutex_t*)&t->lock);
+    return name;
+}
+
+// Dobra a tabela hash e reinsere os IDs pelos hashes guardados.
+static int grow_slots(AttrTable* t) {
+    size_t size = (t->mask + 1) * 2;
+    int* slots = (int*)malloc(size * sizeof(int));
+    if (!slots) return 0;
+    memset(slots, -1, size * sizeof(int));
+    for (int id = 0; id < t->count; id++) {
+        size_t i = t->hashes[id] & (size - 1);
+        while (slots[i] != -1) i = (i + 1) & (size - 1);
+        slots[i] = id;
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->mask = size - 1;
+    return 1;
+}
+
+// Garante espaço para mais um ID e um nome de 'length' bytes. 0 em erro.
+static int reserve_name(AttrTable* t, size_t length) {
+    if (t->count >= t->capacity) {
+        int cap = t->capacity ? t->capacity * 2 : 64;
+        pthread_mutex_lock(&t->lock);
+        uint32_t* hashes = (uint32_t*)realloc(t->hashes, cap * sizeof(uint32_t));
+        if (hashes) t->hashes = hashes;
+        const char** names = (const char**)realloc(t->names, cap * sizeof(const char*));
+        if (names) t->names = names;
+        if (hashes && names) t->capacity = cap;
+        pthread_mutex_unlock(&t->lock);
+        if (!hashes || !names) return 0;
+    }
+    if (!t->blocks || t->blocks->used + length + 1 > t->blocks->size) {
+        // Bloco novo; os anteriores continuam onde estão
+        size_t size = length + 1 > NAME_BLOCK_SIZE ? length + 1 : NAME_BLOCK_SIZE;
+        NameBlock* b = (NameBlock*)malloc(sizeof(NameBlock) + size);
+        if (!b) return 0;
+        b->next = t->blocks;
+        b->used = 0;
+        b->size = size;
+        t->blocks = b;
+    }
+    return 1;
+}
+
+int attr_intern(AttrTable* t, const char* name, size_t length) {
+    uint32_t h = hash_name(name, length);
+    size_t i = h & t->mask;
+    for (; t->slots[i] != -1; i = (i + 1) & t->mask) {
+        int id = t->slots[i];
+        const char* known = t->names[id];
+        if (t->hashes[id] == h && strncmp(known, name, length) == 0 && known[length] == '\0') return id;
+    }
+
+    // Nome novo: garante espaço em todos os vetores antes de registrá-lo
+    if (!reserve_name(t, length)) {
+        perror("Falha ao registrar atributo");
+        return -1;
+    }
+    if ((size_t)(t->count + 1) * 2 > t->mask + 1) {
+        // Mantém a carga abaixo de 1/2; a posição livre muda com o novo tamanho
+        if (!grow_slots(t)) {
+            perror("Falha ao registrar atributo");
+            return -1;
+        }
+        i = h & t->mask;
+        while (t->slots[i] != -1) i = (i + 1) & t->mask;
+    }
+
+    char* copy = t->blocks->data + t->blocks->used;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+    t->blocks->used += length + 1;
+
+    pthread_mutex_lock(&t->lock);
+    int id = t->count;
+    t->names[id] = copy;
+    t->hashes[id] = h;
+    t->count++;
+    pthread_mutex_unlock(&t->lock);
+    t->slots[i] = id;
+    return id;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file atributos.h
+ * @brief Tabela de internalização dos nomes de atributos.
+ *
+ * Cada nome de atributo lido da entrada recebe um ID global (0, 1, 2, ...,
+ * na ordem em que aparece). Os algoritmos não usam esses IDs diretamente:
+ * find_unique_transactions os remapeia para índices densos por
+ * escalonamento (Operation::attr_idx), de modo que as estruturas por
+ * atributo sejam vetores do tamanho do escalonamento, e não do domínio.
+ */
+#ifndef ATRIBUTOS_H
+#define ATRIBUTOS_H
+
+#include <stddef.h>
+
+// Atributo ausente (o "-" das linhas de commit).
+#define NO_ATTR -1
+
+/**
+ * @struct AttrTable
+ * @brief Estado opaco da tabela de nomes.
+ */
+typedef struct AttrTable AttrTable;
+
+/**
+ * @brief Cria uma tabela vazia.
+ * @return A tabela, ou NULL em caso de falha de alocação.
+ */
+AttrTable* attr_table_create(void);
+
+/**
+ * @brief Libera a tabela e os nomes.
+ * @param t A tabela (pode ser NULL).
+ */
+void attr_table_free(AttrTable* t);
+
+/**
+ * @brief Esquece todos os nomes; os próximos IDs recomeçam de 0.
+ *
+ * Só pode ser chamada quando nenhum ID ou nome devolvido antes ainda está
+ * em uso (o modo --gc a chama ao fim de cada escalonamento).
+ *
+ * @param t A tabela.
+ */
+void attr_table_clear(AttrTable* t);
+
+/**
+ * @brief Devolve o ID do nome, registrando-o se ainda não existir.
+ * @param t A tabela.
+ * @param name O nome (não precisa terminar em '\0').
+ * @param length O tamanho do nome em bytes.
+ * @return O ID (>= 0), ou -1 em caso de falha de alocação.
+ */
+int attr_intern(AttrTable* t, const char* name, size_t length);
+
+/**
+ * @brief Número de nomes registrados.
+ * @param t A tabela.
+ * @return Os IDs válidos são 0..count-1.
+ */
+int attr_table_count(const AttrTable* t);
+
+/**
+ * @brief Nome de um ID.
+ *
+ * Pode ser chamada de outras threads enquanto a leitura registra nomes.
+ *
+ * @param t A tabela.
+ * @param id O ID global (ou NO_ATTR).
+ * @return O nome terminado em '\0' ("-" para NO_ATTR). O ponteiro vale até
+ *         attr_table_free.
+ */
+const char* attr_name(const AttrTable* t, int id);
+
+#endif // ATRIBUTOS_H
@@ -0,0 +1,226 @@
+/**
+ * @file bench.c
+ * @brief Benchmarks das fases do escalona (usado por make bench).
+ *
+ * Para cada arquivo de entrada, mede separadamente a leitura (tokenizador),
+ * is_conflict_serializable, has_cycle (sobre grafos já construídos) e
+ * is_view_serializable. Cada fase roda várias vezes e vale o melhor tempo.
+ *
+ * A saída tem uma linha por fase, com campos chave=valor separados por
+ * espaço, por exemplo:
+ *   bench=conflict file=x.in schedules=10 ops=420 ns=8100 ns_per_op=19.29 ops_per_sec=51851851 accepted=7
+ * "accepted" conta os escalonamentos aceitos pelo teste (ou, para has_cycle,
+ * os grafos acíclicos), para conferir que cargas iguais dão respostas iguais.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "algoritmos.h"
+#include "entrada.h"
+
+/**
+ * @struct BenchSet
+ * @brief Escalonamentos de um arquivo, já carregados e prontos para os testes.
+ */
+typedef struct {
+    Schedule** schedules;
+    long count;
+    long capacity;
+    long ops;   // Operações somadas de todos os escalonamentos
+} BenchSet;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void report(const char* phase, const char* path, long schedules, long ops, long long ns, long accepted) {
+    double per_op = ops > 0 ? (double)ns / ops : 0;
+    double per_sec = ns > 0 ? ops * 1e9 / ns : 0;
+    printf("bench=%s file=%s schedules=%ld ops=%ld ns=%lld ns_per_op=%.2f ops_per_sec=%.0f accepted=%ld\n",
+           phase, path, schedules, ops, ns, per_op, per_sec, accepted);
+}
+
+static int append_schedule(BenchSet* set, Schedule* s) {
+    if (set->count == set->capacity) {
+        long cap = set->capacity ? set->capacity * 2 : 256;
+        Schedule** grown = (Schedule**)realloc(set->schedules, cap * sizeof(Schedule*));
+        if (!grown) {
+            perror("Falha ao alocar lista de escalonamentos");
+            return 0;
+        }
+        set->schedules = grown;
+        set->capacity = cap;
+    }
+    find_unique_transactions(s);
+    set->schedules[set->count++] = s;
+    set->ops += s->op_count;
+    return 1;
+}
+
+/**
+ * @brief Lê o arquivo e o divide em escalonamentos, como o escalona.
+ *
+ * Um escalonamento termina quando todas as transações vistas fizeram commit.
+ */
+static int load_set(const char* path, BenchSet* set) {
+    InputReader* input = input_open(path);
+    if (!input) return 0;
+
+    int* open_ids = NULL;
+    int open_count = 0, open_capacity = 0;
+    Schedule* current = create_schedule();
+    Operation op;
+    int status = 0;
+    int ok = current != NULL;
+    while (ok && (status = input_next(input, &op)) == 1) {
+        add_operation(current, op.time, op.trans_id, op.op, op.attr);
+
+        int found = -1;
+        for (int i = 0; i < open_count; i++) {
+            if (open_ids[i] == op.trans_id) found = i;
+        }
+        if (found == -1 && op.op != 'C') {
+            if (open_count == open_capacity) {
+                open_capacity = open_capacity ? open_capacity * 2 : 16;
+                int* grown = (int*)realloc(open_ids, open_capacity * sizeof(int));
+                if (!grown) {
+                    perror("Falha ao alocar lista de transações");
+                    ok = 0;
+                    break;
+                }
+                open_ids = grown;
+            }
+            open_ids[open_count++] = op.trans_id;
+        } else if (found != -1 && op.op == 'C') {
+            open_ids[found] = open_ids[--open_count];
+        }
+
+        if (open_count == 0) {
+            ok = append_schedule(set, current);
+            current = ok ? create_schedule() : NULL;
+            ok = ok && current != NULL;
+        }
+    }
+    if (current && current->op_count > 0 && ok) {
+        ok = append_schedule(set, current);
+    } else {
+        free_schedule(current);
+    }
+    free(open_ids);
+    input_close(input);
+    return ok && status == 0;
+}
+
+static void free_set(BenchSet* set) {
+    for (long i = 0; i < set->count; i++) free_schedule(set->schedules[i]);
+    free(set->schedules);
+}
+
+// Mede a leitura do arquivo inteiro pelo tokenizador.
+static int bench_parser(const char* path, int reps) {
+    long long best = -1;
+    long ops = 0;
+    for (int r = 0; r < reps; r++) {
+        long long start = now_ns();
+        InputReader* input = input_open(path);
+        if (!input) return 0;
+        Operation op;
+        int status;
+        ops = 0;
+        while ((status = input_next(input, &op)) == 1) ops++;
+        input_close(input);
+        if (status < 0) return 0;
+        long long elapsed = now_ns() - start;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    report("parser", path, 0, ops, best, 0);
+    return 1;
+}
+
+static int bench_file(const char* path, int reps) {
+    if (!bench_parser(path, reps)) return 0;
+
+    BenchSet set = {NULL, 0, 0, 0};
+    if (!load_set(path, &set)) {
+        free_set(&set);
+        return 0;
+    }
+
+    long long best = -1;
+    long accepted = 0;
+    for (int r = 0; r < reps; r++) {
+        long long start = now_ns();
+        accepted = 0;
+        for (long i = 0; i < set.count; i++) accepted += is_conflict_serializable(set.schedules[i]);
+        long long elapsed = now_ns() - start;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    report("conflict", path, set.count, set.ops, best, accepted);
+
+    // has_cycle sozinho: os grafos são construídos fora da medição
+    Graph** graphs = (Graph**)calloc(set.count ? set.count : 1, sizeof(Graph*));
+    if (!graphs) {
+        perror("Falha ao alocar lista de grafos");
+        free_set(&set);
+        return 0;
+    }
+    for (long i = 0; i < set.count; i++) graphs[i] = build_conflict_graph(set.schedules[i]);
+    best = -1;
+    for (int r = 0; r < reps; r++) {
+        long long start = now_ns();
+        accepted = 0;
+        for (long i = 0; i < set.count; i++) accepted += graphs[i] && !has_cycle(graphs[i]);
+        long long elapsed = now_ns() - start;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    report("has_cycle", path, set.count, set.ops, best, accepted);
+    for (long i = 0; i < set.count; i++) free_graph(graphs[i]);
+    free(graphs);
+
+    best = -1;
+    for (int r = 0; r < reps; r++) {
+        long long start = now_ns();
+        accepted = 0;
+        for (long i = 0; i < set.count; i++) accepted += is_view_serializable(set.schedules[i]);
+        long long elapsed = now_ns() - start;
+        if (best < 0 || elapsed < best) best = elapsed;
+    }
+    report("view", path, set.count, set.ops, best, accepted);
+
+    free_set(&set);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int reps = 3;
+    int files = 0;
+    int ok = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--reps") == 0) && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+            if (reps < 1) reps = 1;
+        } else if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            int threads = atoi(argv[++i]);
+            set_view_search_threads(threads);
+            set_conflict_threads(threads);
+        } else if (argv[i][0] != '-') {
+            ok = bench_file(argv[i], reps) && ok;
+            files++;
+        } else {
+            files = 0;
+            break;
+        }
+    }
+    if (files == 0) {
+        fprintf(stderr, "Uso: %s [-r N] [-t N] arquivo...\n", argv[0]);
+        fprintf(stderr, "  -r, --reps N      repetições de cada fase; vale o melhor tempo (padrão 3)\n");
+        fprintf(stderr, "  -t, --threads N   threads da busca por permutações do teste por visão e,\n");
+        fprintf(stderr, "                    nos escalonamentos grandes, da geração das arestas de conflito\n");
+        return EXIT_FAILURE;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
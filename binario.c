@@ -0,0 +1,236 @@
+/**
+ * @file binario.c
+ * @brief Implementação do formato binário de escalonamentos.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "binario.h"
+
+struct BinaryWriter {
+    FILE* file;
+    uint64_t offset;           // Posição atual de escrita
+    uint64_t op_count;
+    BinaryIndexEntry* index;
+    long index_count;
+    long index_capacity;
+};
+
+BinaryWriter* binary_create(const char* path) {
+    BinaryWriter* w = (BinaryWriter*)calloc(1, sizeof(BinaryWriter));
+    if (!w) {
+        perror("Falha ao alocar gravador binário");
+        return NULL;
+    }
+    w->file = fopen(path, "wb");
+    if (!w->file) {
+        perror(path);
+        free(w);
+        return NULL;
+    }
+
+    // O cabeçalho definitivo é gravado no fechamento
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, w->file) != 1) {
+        perror(path);
+        fclose(w->file);
+        free(w);
+        return NULL;
+    }
+    w->offset = sizeof(header);
+    return w;
+}
+
+int binary_write_schedule(BinaryWriter* w, const Schedule* s) {
+    if (w->index_count >= w->index_capacity) {
+        long cap = w->index_capacity ? w->index_capacity * 2 : 64;
+        BinaryIndexEntry* idx = (BinaryIndexEntry*)realloc(w->index, cap * sizeof(BinaryIndexEntry));
+        if (!idx) {
+            perror("Falha ao realocar índice binário");
+            return 0;
+        }
+        w->index = idx;
+        w->index_capacity = cap;
+    }
+
+    BinaryIndexEntry* e = &w->index[w->index_count++];
+    e->op_offset = w->offset;
+    e->op_count = (uint32_t)s->op_count;
+    e->trans_offset = w->offset + (uint64_t)s->op_count * sizeof(Operation);
+    e->trans_count = (uint32_t)s->trans_count;
+    e->attr_count = (uint32_t)s->attr_count;
+    e->reserved = 0;
+
+    if (fwrite(s->ops, sizeof(Operation), s->op_count, w->file) != (size_t)s->op_count ||
+        fwrite(s->trans_ids, sizeof(int), s->trans_count, w->file) != (size_t)s->trans_count) {
+        perror("Falha ao gravar escalonamento binário");
+        return 0;
+    }
+    w->offset = e->trans_offset + (uint64_t)s->trans_count * sizeof(int);
+    w->op_count += s->op_count;
+    return 1;
+}
+
+int binary_close_writer(BinaryWriter* w, const AttrTable* attrs) {
+    // Alinha o índice em 8 bytes
+    static const char padding[8] = {0};
+    size_t pad = (size_t)((8 - w->offset % 8) % 8);
+    int ok = fwrite(padding, 1, pad, w->file) == pad;
+    w->offset += pad;
+
+    BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_FORMAT_VERSION;
+    header.byte_order = BINARY_BYTE_ORDER;
+    header.op_record_size = sizeof(Operation);
+    header.schedule_count = (uint64_t)w->index_count;
+    header.op_count = w->op_count;
+    header.index_offset = w->offset;
+    ok = ok && fwrite(w->index, sizeof(BinaryIndexEntry), w->index_count, w->file) == (size_t)w->index_count;
+    w->offset += (uint64_t)w->index_count * sizeof(BinaryIndexEntry);
+
+    // Tabela de nomes: deslocamentos e depois os nomes
+    int names = attrs ? attr_table_count(attrs) : 0;
+    header.attr_count = (uint64_t)names;
+    header.attr_names_offset = w->offset;
+    uint64_t name_offset = 0;
+    for (int id = 0; ok && id < names; id++) {
+        ok = fwrite(&name_offset, sizeof(name_offset), 1, w->file) == 1;
+        name_offset += strlen(attr_name(attrs, id)) + 1;
+    }
+    for (int id = 0; ok && id < names; id++) {
+        const char* name = attr_name(attrs, id);
+        ok = fwrite(name, 1, strlen(name) + 1, w->file) == strlen(name) + 1;
+    }
+    ok = ok && fseek(w->file, 0, SEEK_SET) == 0;
+    ok = ok && fwrite(&header, sizeof(header), 1, w->file) == 1;
+    if (fclose(w->file) != 0) ok = 0;
+    if (!ok) perror("Falha ao finalizar arquivo binário");
+
+    free(w->index);
+    free(w);
+    return ok;
+}
+
+static BinaryFile* invalid_file(BinaryFile* f, const char* path, const char* reason) {
+    fprintf(stderr, "%s: %s\n", path, reason);
+    binary_close(f);
+    return NULL;
+}
+
+BinaryFile* binary_open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return NULL;
+    }
+
+    BinaryFile* f = (BinaryFile*)calloc(1, sizeof(BinaryFile));
+    if (!f) {
+        perror("Falha ao alocar arquivo binário");
+        close(fd);
+        return NULL;
+    }
+    if ((size_t)st.st_size < sizeof(BinaryHeader)) {
+        close(fd);
+        return invalid_file(f, path, "arquivo binário truncado");
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        free(f);
+        return NULL;
+    }
+    f->data = (const unsigned char*)map;
+    f->size = (size_t)st.st_size;
+    f->header = (const BinaryHeader*)f->data;
+
+    const BinaryHeader* h = f->header;
+    if (memcmp(h->magic, BINARY_MAGIC, sizeof(h->magic)) != 0) {
+        return invalid_file(f, path, "não é um arquivo binário de escalonamentos");
+    }
+    if (h->version != BINARY_FORMAT_VERSION || h->byte_order != BINARY_BYTE_ORDER ||
+        h->op_record_size != sizeof(Operation)) {
+        return invalid_file(f, path, "versão ou arquitetura do arquivo binário incompatível");
+    }
+    if (h->index_offset > f->size ||
+        h->schedule_count > (f->size - h->index_offset) / sizeof(BinaryIndexEntry)) {
+        return invalid_file(f, path, "índice do arquivo binário truncado");
+    }
+    f->index = (const BinaryIndexEntry*)(f->data + h->index_offset);
+
+    for (uint64_t i = 0; i < h->schedule_count; i++) {
+        const BinaryIndexEntry* e = &f->index[i];
+        if (e->op_offset + (uint64_t)e->op_count * sizeof(Operation) > h->index_offset ||
+            e->trans_offset + (uint64_t)e->trans_count * sizeof(int) > h->index_offset) {
+            return invalid_file(f, path, "entrada do índice fora do arquivo");
+        }
+    }
+
+    if (h->attr_names_offset > f->size || h->attr_names_offset % 8 != 0 ||
+        h->attr_count > (f->size - h->attr_names_offset) / sizeof(uint64_t)) {
+        return invalid_file(f, path, "tabela de nomes do arquivo binário truncada");
+    }
+    f->attr_offsets = (const uint64_t*)(f->data + h->attr_names_offset);
+    f->attr_names = (const char*)(f->attr_offsets + h->attr_count);
+    size_t names_size = f->size - (size_t)((const unsigned char*)f->attr_names - f->data);
+    // Cada nome precisa terminar dentro do arquivo
+    if (h->attr_count > 0 && (names_size == 0 || f->attr_names[names_size - 1] != '\0')) {
+        return invalid_file(f, path, "tabela de nomes do arquivo binário truncada");
+    }
+    for (uint64_t i = 0; i < h->attr_count; i++) {
+        if (f->attr_offsets[i] >= names_size) {
+            return invalid_file(f, path, "tabela de nomes do arquivo binário truncada");
+        }
+    }
+    return f;
+}
+
+long binary_schedule_count(const BinaryFile* f) {
+    return (long)f->header->schedule_count;
+}
+
+Schedule* binary_schedule_view(const BinaryFile* f, long n, Arena* arena) {
+    if (n < 0 || (uint64_t)n >= f->header->schedule_count) return NULL;
+
+    Schedule* s = (Schedule*)arena_calloc(arena, 1, sizeof(Schedule));
+    if (!s) {
+        perror("Falha ao alocar Schedule");
+        return NULL;
+    }
+    const BinaryIndexEntry* e = &f->index[n];
+    // Os dados ficam no mapa somente leitura; o Schedule não é dono deles
+    s->ops = (Operation*)(f->data + e->op_offset);
+    s->op_count = (int)e->op_count;
+    s->op_capacity = s->op_count;
+    s->trans_ids = (int*)(f->data + e->trans_offset);
+    s->trans_count = (int)e->trans_count;
+    s->attr_count = (int)e->attr_count;
+    s->owns_data = 0;
+    s->arena = arena;
+    return s;
+}
+
+const char* binary_attr_name(const BinaryFile* f, int id) {
+    if (id < 0 || (uint64_t)id >= f->header->attr_count) return "-";
+    return f->attr_names + f->attr_offsets[id];
+}
+
+void binary_close(BinaryFile* f) {
+    if (!f) return;
+    if (f->data) munmap((void*)f->data, f->size);
+    free(f);
+}
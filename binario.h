@@ -0,0 +1,149 @@
+/**
+ * @file binario.h
+ * @brief Formato binário compacto de escalonamentos, conversor e carregador.
+ *
+ * Layout do arquivo (inteiros na ordem de bytes da máquina que o gerou):
+ *
+ *   BinaryHeader
+ *   para cada escalonamento:
+ *     op_count registros Operation (com trans_idx e attr_idx já calculados)
+ *     trans_count IDs de transação (int32, em ordem crescente)
+ *   índice: schedule_count registros BinaryIndexEntry
+ *   nomes de atributo: attr_count deslocamentos (uint64, relativos ao fim
+ *     deles) seguidos dos nomes terminados em '\0', na ordem dos IDs globais
+ *
+ * O índice permite ir direto ao escalonamento N. O carregador mapeia o
+ * arquivo e entrega Schedules que apontam para os dados mapeados, sem cópia.
+ */
+#ifndef BINARIO_H
+#define BINARIO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "algoritmos.h"
+
+#define BINARY_MAGIC "ESCALONA"
+#define BINARY_FORMAT_VERSION 2
+#define BINARY_BYTE_ORDER 0x01020304u
+
+/**
+ * @struct BinaryHeader
+ * @brief Cabeçalho do arquivo binário.
+ */
+typedef struct {
+    char magic[8];            // BINARY_MAGIC, sem o '\0'
+    uint32_t version;         // BINARY_FORMAT_VERSION
+    uint32_t byte_order;      // BINARY_BYTE_ORDER, para detectar outra arquitetura
+    uint32_t op_record_size;  // sizeof(Operation) de quem gravou
+    uint32_t reserved;
+    uint64_t schedule_count;  // Número de escalonamentos
+    uint64_t op_count;        // Total de operações
+    uint64_t index_offset;    // Posição do índice no arquivo
+    uint64_t attr_count;      // Número de nomes de atributo
+    uint64_t attr_names_offset; // Posição da tabela de nomes
+} BinaryHeader;
+
+/**
+ * @struct BinaryIndexEntry
+ * @brief Entrada do índice: onde estão as operações e transações de um escalonamento.
+ */
+typedef struct {
+    uint64_t op_offset;       // Posição do primeiro registro Operation
+    uint64_t trans_offset;    // Posição do primeiro ID de transação
+    uint32_t op_count;
+    uint32_t trans_count;
+    uint32_t attr_count;      // Atributos distintos (índices densos) do escalonamento
+    uint32_t reserved;
+} BinaryIndexEntry;
+
+/**
+ * @struct BinaryWriter
+ * @brief Estado opaco da gravação de um arquivo binário.
+ */
+typedef struct BinaryWriter BinaryWriter;
+
+/**
+ * @struct BinaryFile
+ * @brief Arquivo binário aberto (mapeado) para leitura.
+ * @var BinaryFile::data O arquivo mapeado.
+ * @var BinaryFile::size Tamanho do arquivo.
+ * @var BinaryFile::header O cabeçalho, dentro do mapa.
+ * @var BinaryFile::index O índice de escalonamentos, dentro do mapa.
+ * @var BinaryFile::attr_offsets Deslocamento do nome de cada atributo, dentro do mapa.
+ * @var BinaryFile::attr_names Início dos nomes de atributo, dentro do mapa.
+ */
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    const BinaryHeader* header;
+    const BinaryIndexEntry* index;
+    const uint64_t* attr_offsets;
+    const char* attr_names;
+} BinaryFile;
+
+/**
+ * @brief Cria um arquivo binário para gravação.
+ * @param path O caminho do arquivo.
+ * @return O gravador, ou NULL em caso de erro (já reportado).
+ */
+BinaryWriter* binary_create(const char* path);
+
+/**
+ * @brief Grava um escalonamento completo.
+ * @param w O gravador.
+ * @param s O escalonamento, com find_unique_transactions já executado.
+ * @return 1 em caso de sucesso, 0 em caso de erro de escrita.
+ */
+int binary_write_schedule(BinaryWriter* w, const Schedule* s);
+
+/**
+ * @brief Grava o índice, os nomes de atributo e o cabeçalho e fecha o arquivo.
+ * @param w O gravador.
+ * @param attrs A tabela de nomes dos IDs globais gravados (pode ser NULL).
+ * @return 1 em caso de sucesso, 0 em caso de erro de escrita.
+ */
+int binary_close_writer(BinaryWriter* w, const AttrTable* attrs);
+
+/**
+ * @brief Abre e valida um arquivo binário, mapeando-o em memória.
+ * @param path O caminho do arquivo.
+ * @return O arquivo aberto, ou NULL em caso de erro (já reportado).
+ */
+BinaryFile* binary_open(const char* path);
+
+/**
+ * @brief Número de escalonamentos do arquivo.
+ * @param f O arquivo aberto.
+ * @return O número de escalonamentos.
+ */
+long binary_schedule_count(const BinaryFile* f);
+
+/**
+ * @brief Cria uma visão do escalonamento de índice n (0 = primeiro).
+ *
+ * A visão aponta para os dados mapeados (somente leitura) e já tem
+ * trans_ids, trans_idx, attr_idx e attr_count preenchidos. Deve ser liberada com free_schedule,
+ * que não toca nos dados do arquivo.
+ *
+ * @param f O arquivo aberto.
+ * @param n O índice do escalonamento.
+ * @param arena Arena da estrutura e da análise, ou NULL para usar o heap.
+ * @return A visão, ou NULL se n estiver fora do intervalo.
+ */
+Schedule* binary_schedule_view(const BinaryFile* f, long n, Arena* arena);
+
+/**
+ * @brief Nome de um atributo pelo seu ID global.
+ * @param f O arquivo aberto.
+ * @param id O ID global (Operation::attr).
+ * @return O nome, dentro do mapa ("-" para NO_ATTR ou ID inválido).
+ */
+const char* binary_attr_name(const BinaryFile* f, int id);
+
+/**
+ * @brief Desfaz o mapeamento e libera o arquivo.
+ * @param f O arquivo aberto.
+ */
+void binary_close(BinaryFile* f);
+
+#endif // BINARIO_H
@@ -0,0 +1,283 @@
+/**
+ * @file cache.c
+ * @brief Implementação do cache de vereditos (LRU com encadeamento por hash).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cache.h"
+
+// Primeira linha do arquivo do cache. A versão muda junto com a codificação
+// da assinatura (schedule_signature): entradas de outra versão não
+// corresponderiam aos mesmos escalonamentos.
+#define CACHE_MAGIC "escalona-cache"
+#define CACHE_VERSION 1
+
+typedef struct {
+    uint64_t hash;
+    int* data;
+    int length;
+    signed char conflict;
+    signed char view;
+    int prev, next;   // Lista LRU (-1 nas pontas)
+    int chain;        // Próxima entrada do mesmo balde (-1 no fim)
+} CacheEntry;
+
+struct VerdictCache {
+    CacheEntry* entries;
+    int capacity;
+    int count;
+    int* buckets;     // Primeira entrada de cada balde (-1 se vazio)
+    size_t mask;
+    int lru_head;     // Mais recentemente usada
+    int lru_tail;     // Menos recentemente usada
+    long lookups;
+    long hits;
+    pthread_mutex_t lock;
+};
+
+int schedule_signature(Schedule* s, ScheduleSignature* sig) {
+    if (!schedule_columns(s)) return 0;
+    sig->length = 2 * s->op_count;
+    sig->data = (int*)arena_alloc(s->arena, (sig->length + 1) * sizeof(int));
+    int* first = (int*)arena_alloc(s->arena, (s->trans_count + 1) * sizeof(int));
+    if (!sig->data || !first) {
+        perror("Falha ao alocar assinatura do escalonamento");
+        arena_free(s->arena, first);
+        return 0;
+    }
+    for (int t = 0; t < s->trans_count; t++) first[t] = -1;
+
+    // Transações pela primeira aparição; attr_idx já segue essa ordem
+    int next = 0;
+    uint64_t h = 14695981039346656037ull;
+    const int* col_trans = s->cols.trans;
+    for (int i = 0; i < s->op_count; i++) {
+        int t = col_trans[i];
+        if (first[t] == -1) first[t] = next++;
+        sig->data[2 * i] = first[t];
+        sig->data[2 * i + 1] = (s->cols.attr[i] + 1) * 4 + s->cols.kind[i];
+        for (int k = 0; k < 2; k++) {
+            h ^= (uint32_t)sig->data[2 * i + k];
+            h *= 1099511628211ull;
+        }
+    }
+    sig->hash = h;
+    arena_free(s->arena, first);
+    return 1;
+}
+
+VerdictCache* cache_create(int capacity) {
+    if (capacity < 1) capacity = 1;
+    VerdictCache* c = (VerdictCache*)calloc(1, sizeof(VerdictCache));
+    if (!c) {
+        perror("Falha ao alocar cache de vereditos");
+        return NULL;
+    }
+    size_t buckets = 16;
+    while (buckets < (size_t)capacity * 2) buckets *= 2;
+    c->entries = (CacheEntry*)malloc(capacity * sizeof(CacheEntry));
+    c->buckets = (int*)malloc(buckets * sizeof(int));
+    if (!c->entries || !c->buckets) {
+        perror("Falha ao alocar cache de vereditos");
+        cache_free(c);
+        return NULL;
+    }
+    memset(c->buckets, -1, buckets * sizeof(int));
+    c->capacity = capacity;
+    c->mask = buckets - 1;
+    c->lru_head = c->lru_tail = -1;
+    pthread_mutex_init(&c->lock, NULL);
+    return c;
+}
+
+static void lru_unlink(VerdictCache* c, int e) {
+    CacheEntry* en = &c->entries[e];
+    if (en->prev != -1) c->entries[en->prev].next = en->next;
+    else c->lru_head = en->next;
+    if (en->next != -1) c->entries[en->next].prev = en->prev;
+    else c->lru_tail = en->prev;
+}
+
+static void lru_push_front(VerdictCache* c, int e) {
+    c->entries[e].prev = -1;
+    c->entries[e].next = c->lru_head;
+    if (c->lru_head != -1) c->entries[c->lru_head].prev = e;
+    c->lru_head = e;
+    if (c->lru_tail == -1) c->lru_tail = e;
+}
+
+// Procura a entrada da assinatura (com o lock já tomado); -1 se não existe.
+static int find_entry(VerdictCache* c, const ScheduleSignature* sig) {
+    for (int e = c->buckets[sig->hash & c->mask]; e != -1; e = c->entries[e].chain) {
+        CacheEntry* en = &c->entries[e];
+        if (en->hash == sig->hash && en->length == sig->length &&
+            memcmp(en->data, sig->data, sig->length * sizeof(int)) == 0) {
+            return e;
+        }
+    }
+    return -1;
+}
+
+int cache_lookup(VerdictCache* c, const ScheduleSignature* sig, int* conflict, int* view) {
+    pthread_mutex_lock(&c->lock);
+    c->lookups++;
+    int e = find_entry(c, sig);
+    if (e != -1) {
+        c->hits++;
+        *conflict = c->entries[e].conflict;
+        *view = c->entries[e].view;
+        lru_unlink(c, e);
+        lru_push_front(c, e);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return e != -1;
+}
+
+// Insere com o lock já tomado.
+static void insert_locked(VerdictCache* c, const ScheduleSignature* sig, int conflict, int view) {
+    int e = find_entry(c, sig);
+    if (e != -1) {
+        // Outra thread já guardou a mesma forma: só renova
+        lru_unlink(c, e);
+        lru_push_front(c, e);
+        return;
+    }
+
+    int* data = (int*)malloc((sig->length + 1) * sizeof(int));
+    if (!data) return; // Sem memória: o escalonamento só não fica no cache
+    memcpy(data, sig->data, sig->length * sizeof(int));
+
+    if (c->count < c->capacity) {
+        e = c->count++;
+    } else {
+        // Descarta a menos recentemente usada e tira-a do seu balde
+        e = c->lru_tail;
+        lru_unlink(c, e);
+        int* link = &c->buckets[c->entries[e].hash & c->mask];
+        while (*link != e) link = &c->entries[*link].chain;
+        *link = c->entries[e].chain;
+        free(c->entries[e].data);
+    }
+
+    CacheEntry* en = &c->entries[e];
+    en->hash = sig->hash;
+    en->data = data;
+    en->length = sig->length;
+    en->conflict = (signed char)conflict;
+    en->view = (signed char)view;
+    en->chain = c->buckets[sig->hash & c->mask];
+    c->buckets[sig->hash & c->mask] = e;
+    lru_push_front(c, e);
+}
+
+void cache_insert(VerdictCache* c, const ScheduleSignature* sig, int conflict, int view) {
+    pthread_mutex_lock(&c->lock);
+    insert_locked(c, sig, conflict, view);
+    pthread_mutex_unlock(&c->lock);
+}
+
+// Descarta todas as entradas (as contagens de consultas ficam).
+static void cache_clear(VerdictCache* c) {
+    for (int e = 0; e < c->count; e++) free(c->entries[e].data);
+    c->count = 0;
+    memset(c->buckets, -1, (c->mask + 1) * sizeof(int));
+    c->lru_head = c->lru_tail = -1;
+}
+
+int cache_load(VerdictCache* c, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return 1; // Primeira execução: cache vazio
+
+    int conflict, view, length;
+    int* data = NULL;
+    int capacity = 0;
+    int version = 0;
+    int ok = fscanf(f, CACHE_MAGIC " %d", &version) == 1 && version == CACHE_VERSION;
+    while (ok && fscanf(f, "%d %d %d", &conflict, &view, &length) == 3) {
+        if (length < 0 || length % 2 != 0) {
+            ok = 0;
+            break;
+        }
+        if (length + 1 > capacity) {
+            int* grown = (int*)realloc(data, (length + 1) * sizeof(int));
+            if (!grown) {
+                perror("Falha ao alocar cache de vereditos");
+                ok = 0;
+                break;
+            }
+            data = grown;
+            capacity = length + 1;
+        }
+        uint64_t h = 14695981039346656037ull;
+        for (int i = 0; ok && i < length; i++) {
+            ok = fscanf(f, "%d", &data[i]) == 1;
+            h ^= (uint32_t)data[i];
+            h *= 1099511628211ull;
+        }
+        ScheduleSignature sig = {data, length, h};
+        if (ok) insert_locked(c, &sig, conflict != 0, view != 0);
+    }
+    if (!ok || !feof(f)) {
+        // O cache só economiza trabalho: sem ele a execução continua igual
+        fprintf(stderr, "escalona: aviso: %s: arquivo de cache inválido ou de outra versão; começando vazio\n", path);
+        cache_clear(c);
+        ok = 0;
+    }
+    free(data);
+    fclose(f);
+    return ok;
+}
+
+int cache_save(VerdictCache* c, const char* path) {
+    // O arquivo antigo só é trocado depois que o novo está inteiro no disco
+    size_t path_len = strlen(path);
+    char* tmp_path = (char*)malloc(path_len + sizeof(".tmp"));
+    if (!tmp_path) {
+        perror("Falha ao alocar cache de vereditos");
+        return 0;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE* f = fopen(tmp_path, "w");
+    if (!f) {
+        perror(tmp_path);
+        free(tmp_path);
+        return 0;
+    }
+    fprintf(f, CACHE_MAGIC " %d\n", CACHE_VERSION);
+    // Da menos para a mais recente: carregar na mesma ordem refaz a LRU
+    for (int e = c->lru_tail; e != -1; e = c->entries[e].prev) {
+        CacheEntry* en = &c->entries[e];
+        fprintf(f, "%d %d %d", en->conflict, en->view, en->length);
+        for (int i = 0; i < en->length; i++) fprintf(f, " %d", en->data[i]);
+        fputc('\n', f);
+    }
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        perror(path);
+        remove(tmp_path);
+        free(tmp_path);
+        return 0;
+    }
+    free(tmp_path);
+    return 1;
+}
+
+void cache_report(VerdictCache* c, FILE* out) {
+    fprintf(out, "escalona: cache: %ld acertos em %ld consultas (%.1f%%), %d formas guardadas\n",
+            c->hits, c->lookups, c->lookups ? 100.0 * c->hits / c->lookups : 0.0, c->count);
+}
+
+void cache_free(VerdictCache* c) {
+    if (!c) return;
+    for (int e = 0; e < c->count; e++) free(c->entries[e].data);
+    free(c->entries);
+    free(c->buckets);
+    if (c->capacity) pthread_mutex_destroy(&c->lock);
+    free(c);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file cache.h
+ * @brief Cache de vereditos para escalonamentos com a mesma forma (--cache).
+ *
+ * Dois escalonamentos que só diferem nos IDs de transação e de atributo e
+ * nos tempos têm os mesmos vereditos. A assinatura canônica renumera
+ * transações e atributos pela ordem da primeira aparição e descarta os
+ * tempos; o cache guarda, para as assinaturas mais recentes (LRU, com
+ * tamanho limitado), os vereditos por conflito e por visão.
+ *
+ * O cache compara a assinatura inteira, não só o hash, então uma colisão
+ * nunca devolve o veredito de outro escalonamento.
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "algoritmos.h"
+
+// Capacidade padrão do cache (em escalonamentos).
+#define CACHE_DEFAULT_CAPACITY 4096
+
+/**
+ * @struct ScheduleSignature
+ * @brief Forma canônica de um escalonamento.
+ * @var ScheduleSignature::data Dois inteiros por operação: a transação
+ *      renumerada e (atributo renumerado + 1) * 4 + tipo da operação.
+ * @var ScheduleSignature::length Número de inteiros em data.
+ * @var ScheduleSignature::hash Hash de data.
+ */
+typedef struct {
+    int* data;
+    int length;
+    uint64_t hash;
+} ScheduleSignature;
+
+/**
+ * @struct VerdictCache
+ * @brief Estado opaco do cache.
+ */
+typedef struct VerdictCache VerdictCache;
+
+/**
+ * @brief Calcula a assinatura canônica de um escalonamento.
+ * @param s O escalonamento (com find_unique_transactions já chamado; as
+ *        colunas são montadas se ainda não existem).
+ * @param sig Recebe a assinatura (data alocado na arena do escalonamento).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int schedule_signature(Schedule* s, ScheduleSignature* sig);
+
+/**
+ * @brief Cria um cache vazio.
+ * @param capacity Máximo de escalonamentos guardados.
+ * @return O cache, ou NULL em caso de falha de alocação.
+ */
+VerdictCache* cache_create(int capacity);
+
+/**
+ * @brief Procura os vereditos de uma assinatura (seguro entre threads).
+ * @param c O cache.
+ * @param sig A assinatura.
+ * @param conflict Recebe o veredito por conflito, se achado.
+ * @param view Recebe o veredito por visão, se achado.
+ * @return 1 se achou, 0 caso contrário.
+ */
+int cache_lookup(VerdictCache* c, const ScheduleSignature* sig, int* conflict, int* view);
+
+/**
+ * @brief Guarda os vereditos de uma assinatura, descartando a menos usada
+ *        se o cache estiver cheio (seguro entre threads).
+ * @param c O cache.
+ * @param sig A assinatura (copiada).
+ * @param conflict O veredito por conflito (0 ou 1).
+ * @param view O veredito por visão (0 ou 1).
+ */
+void cache_insert(VerdictCache* c, const ScheduleSignature* sig, int conflict, int view);
+
+/**
+ * @brief Carrega as entradas gravadas por cache_save.
+ *
+ * Um arquivo sem o cabeçalho desta versão, ou com erro de leitura, é
+ * ignorado com um aviso em stderr: o cache fica vazio e a execução segue.
+ *
+ * @param c O cache.
+ * @param path O arquivo (se não existir, o cache fica como está).
+ * @return 1 se as entradas foram carregadas, 0 se o arquivo foi ignorado.
+ */
+int cache_load(VerdictCache* c, const char* path);
+
+/**
+ * @brief Grava as entradas, da menos para a mais recentemente usada.
+ *
+ * Grava path.tmp, com o cabeçalho de versão, e o renomeia para path: uma
+ * gravação interrompida deixa o cache anterior intacto.
+ *
+ * @param c O cache.
+ * @param path O arquivo (sobrescrito).
+ * @return 1 em caso de sucesso, 0 em erro de escrita.
+ */
+int cache_save(VerdictCache* c, const char* path);
+
+/**
+ * @brief Imprime consultas, acertos e a taxa de acerto.
+ * @param c O cache.
+ * @param out Onde imprimir.
+ */
+void cache_report(VerdictCache* c, FILE* out);
+
+/**
+ * @brief Libera o cache.
+ * @param c O cache (pode ser NULL).
+ */
+void cache_free(VerdictCache* c);
+
+#endif // CACHE_H
@@ -0,0 +1,382 @@
+/**
+ * @file entrada.c
+ * @brief Implementação da leitura da entrada com mmap ou blocos.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "entrada.h"
+
+// Tamanho de cada leitura quando a entrada não pode ser mapeada.
+#define INPUT_BLOCK_SIZE (1 << 20)
+
+// Blocos na fila entre a thread de leitura e o leitor (2 = buffer duplo).
+#define INPUT_RING_BLOCKS 2
+
+// Janela do mapa pedida ao sistema antes de ser lida (MADV_WILLNEED).
+#define INPUT_PREFETCH_WINDOW (8 << 20)
+
+// Um bloco lido pela thread de leitura; size 0 marca o fim da entrada.
+typedef struct {
+    char* data;
+    size_t size;
+} InputBlock;
+
+// Fila circular de blocos com um produtor (a thread de leitura) e um
+// consumidor (o leitor). Cada lado só escreve o seu índice, então a
+// passagem de um bloco não toma trava; o mutex e a condição servem apenas
+// para dormir com a fila vazia (leitor) ou cheia (thread de leitura).
+struct InputPrefetch {
+    int fd;
+    pthread_t thread;
+    InputBlock blocks[INPUT_RING_BLOCKS];
+    atomic_size_t head;          // Próximo bloco a consumir (escrito pelo leitor)
+    atomic_size_t tail;          // Próximo bloco a preencher (escrito pela thread)
+    atomic_int consumer_waiting;
+    atomic_int producer_waiting;
+    atomic_int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+typedef struct InputPrefetch InputPrefetch;
+
+static int ring_has_block(InputPrefetch* pf) {
+    return atomic_load(&pf->tail) != atomic_load(&pf->head);
+}
+
+static int ring_has_space(InputPrefetch* pf) {
+    return atomic_load(&pf->tail) - atomic_load(&pf->head) < INPUT_RING_BLOCKS || atomic_load(&pf->stop);
+}
+
+// Dorme até ready(pf). A marca 'waiting' é publicada antes de reconferir a
+// fila, e o outro lado publica o seu índice antes de ler a marca: um dos
+// dois sempre vê a mudança do outro, então o aviso não se perde.
+static void ring_wait(InputPrefetch* pf, atomic_int* waiting, int (*ready)(InputPrefetch*)) {
+    pthread_mutex_lock(&pf->lock);
+    atomic_store(waiting, 1);
+    while (!ready(pf)) pthread_cond_wait(&pf->changed, &pf->lock);
+    atomic_store(waiting, 0);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+static void ring_wake(InputPrefetch* pf, atomic_int* waiting) {
+    if (!atomic_load(waiting)) return;
+    pthread_mutex_lock(&pf->lock);
+    pthread_cond_broadcast(&pf->changed);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+// Thread de leitura: preenche os blocos livres até o fim da entrada.
+static void* prefetch_run(void* arg) {
+    InputPrefetch* pf = (InputPrefetch*)arg;
+    // Só pode ser cancelada dentro do read (input_close antes do fim da entrada)
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    for (;;) {
+        if (!ring_has_space(pf)) ring_wait(pf, &pf->producer_waiting, ring_has_space);
+        if (atomic_load(&pf->stop)) break;
+
+        size_t tail = atomic_load_explicit(&pf->tail, memory_order_relaxed);
+        InputBlock* b = &pf->blocks[tail % INPUT_RING_BLOCKS];
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        ssize_t got = read(pf->fd, b->data, INPUT_BLOCK_SIZE);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) perror("Falha ao ler a entrada");
+        b->size = got > 0 ? (size_t)got : 0;
+
+        atomic_store(&pf->tail, tail + 1);
+        ring_wake(pf, &pf->consumer_waiting);
+        if (got <= 0) break;
+    }
+    return NULL;
+}
+
+static void prefetch_free(InputPrefetch* pf) {
+    for (int i = 0; i < INPUT_RING_BLOCKS; i++) free(pf->blocks[i].data);
+    pthread_mutex_destroy(&pf->lock);
+    pthread_cond_destroy(&pf->changed);
+    free(pf);
+}
+
+// Inicia a thread de leitura de fd. NULL se não for possível (lê direto).
+static InputPrefetch* prefetch_start(int fd) {
+    InputPrefetch* pf = (InputPrefetch*)calloc(1, sizeof(InputPrefetch));
+    if (!pf) return NULL;
+    pf->fd = fd;
+    atomic_init(&pf->head, 0);
+    atomic_init(&pf->tail, 0);
+    atomic_init(&pf->consumer_waiting, 0);
+    atomic_init(&pf->producer_waiting, 0);
+    atomic_init(&pf->stop, 0);
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->changed, NULL);
+    int ok = 1;
+    for (int i = 0; i < INPUT_RING_BLOCKS; i++) {
+        pf->blocks[i].data = (char*)malloc(INPUT_BLOCK_SIZE);
+        if (!pf->blocks[i].data) ok = 0;
+    }
+    if (!ok || pthread_create(&pf->thread, NULL, prefetch_run, pf) != 0) {
+        prefetch_free(pf);
+        return NULL;
+    }
+    return pf;
+}
+
+static void prefetch_stop(InputPrefetch* pf) {
+    atomic_store(&pf->stop, 1);
+    pthread_mutex_lock(&pf->lock);
+    pthread_cond_broadcast(&pf->changed);
+    pthread_mutex_unlock(&pf->lock);
+    // Se a entrada não acabou, a thread pode estar parada no read
+    pthread_cancel(pf->thread);
+    pthread_join(pf->thread, NULL);
+    prefetch_free(pf);
+}
+
+InputReader* input_open(const char* path) {
+    InputReader* in = (InputReader*)calloc(1, sizeof(InputReader));
+    if (!in) {
+        perror("Falha ao alocar leitor de entrada");
+        return NULL;
+    }
+
+    in->attrs = attr_table_create();
+    if (!in->attrs) {
+        free(in);
+        return NULL;
+    }
+
+    in->fd = path ? open(path, O_RDONLY) : STDIN_FILENO;
+    if (in->fd < 0) {
+        perror(path);
+        attr_table_free(in->attrs);
+        free(in);
+        return NULL;
+    }
+
+    // Arquivos regulares são mapeados inteiros; o resto é lido em blocos
+    struct stat st;
+    if (fstat(in->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, in->fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+            in->data = (const char*)map;
+            in->size = (size_t)st.st_size;
+            in->mapped = 1;
+            in->eof = 1;
+            return in;
+        }
+    }
+
+    in->buffer_capacity = INPUT_BLOCK_SIZE;
+    in->buffer = (char*)malloc(in->buffer_capacity);
+    if (!in->buffer) {
+        perror("Falha ao alocar buffer de entrada");
+        input_close(in);
+        return NULL;
+    }
+    in->data = in->buffer;
+    // Sem a thread, os blocos são lidos na hora, pelo próprio leitor
+    in->prefetch = prefetch_start(in->fd);
+    return in;
+}
+
+void input_close(InputReader* in) {
+    if (!in) return;
+    if (in->prefetch) prefetch_stop(in->prefetch);
+    if (in->mapped) munmap((void*)in->data, in->size);
+    if (in->fd > STDIN_FILENO) close(in->fd);
+    free(in->buffer);
+    attr_table_free(in->attrs);
+    free(in);
+}
+
+/**
+ * @brief Acrescenta ao buffer o próximo bloco da thread de leitura.
+ * @return 1 se leu dados, 0 se a entrada acabou.
+ */
+static int take_block(InputReader* in) {
+    InputPrefetch* pf = in->prefetch;
+    if (!ring_has_block(pf)) ring_wait(pf, &pf->consumer_waiting, ring_has_block);
+
+    size_t head = atomic_load_explicit(&pf->head, memory_order_relaxed);
+    const InputBlock* b = &pf->blocks[head % INPUT_RING_BLOCKS];
+    size_t got = b->size;
+    int ok = 1;
+    if (in->size + got > in->buffer_capacity) {
+        // A linha incompleta mais um bloco inteiro fazem o buffer crescer
+        size_t capacity = in->buffer_capacity * 2;
+        while (capacity < in->size + got) capacity *= 2;
+        char* bigger = (char*)realloc(in->buffer, capacity);
+        if (!bigger) {
+            perror("Falha ao realocar buffer de entrada");
+            ok = 0;
+        } else {
+            in->buffer = bigger;
+            in->buffer_capacity = capacity;
+            in->data = in->buffer;
+        }
+    }
+    if (ok) {
+        memcpy(in->buffer + in->size, b->data, got);
+        in->size += got;
+    }
+
+    // Devolve o bloco: a thread já pode ler o seguinte nele
+    atomic_store(&pf->head, head + 1);
+    ring_wake(pf, &pf->producer_waiting);
+    if (!ok || got == 0) {
+        in->eof = 1;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Lê mais um bloco, preservando a linha incompleta no início do buffer.
+ * @return 1 se leu dados, 0 se a entrada acabou.
+ */
+static int refill(InputReader* in) {
+    size_t pending = in->size - in->pos;
+    memmove(in->buffer, in->buffer + in->pos, pending);
+    in->pos = 0;
+    in->size = pending;
+    if (in->prefetch) return take_block(in);
+
+    // Uma linha maior que o buffer faz o buffer crescer
+    if (in->size == in->buffer_capacity) {
+        char* bigger = (char*)realloc(in->buffer, in->buffer_capacity * 2);
+        if (!bigger) {
+            perror("Falha ao realocar buffer de entrada");
+            in->eof = 1;
+            return 0;
+        }
+        in->buffer = bigger;
+        in->buffer_capacity *= 2;
+        in->data = in->buffer;
+    }
+
+    ssize_t got = read(in->fd, in->buffer + in->size, in->buffer_capacity - in->size);
+    if (got < 0) perror("Falha ao ler a entrada");
+    if (got <= 0) {
+        in->eof = 1;
+        return 0;
+    }
+    in->size += (size_t)got;
+    return 1;
+}
+
+/**
+ * @brief Localiza a próxima linha completa (ou a última, sem '\n').
+ * @param start Recebe o início da linha.
+ * @param end Recebe o fim da linha (sem o '\n').
+ * @return 1 se há uma linha, 0 no fim da entrada.
+ */
+static int next_line(InputReader* in, const char** start, const char** end) {
+    // No mapa, a próxima janela é pedida enquanto a metade da atual é lida
+    if (in->mapped && in->pos + INPUT_PREFETCH_WINDOW / 2 >= in->advised && in->advised < in->size) {
+        size_t length = in->size - in->advised;
+        if (length > INPUT_PREFETCH_WINDOW) length = INPUT_PREFETCH_WINDOW;
+        madvise((void*)(in->data + in->advised), length, MADV_WILLNEED);
+        in->advised += length;
+    }
+    for (;;) {
+        const char* p = in->data + in->pos;
+        const char* nl = (const char*)memchr(p, '\n', in->size - in->pos);
+        if (nl) {
+            *start = p;
+            *end = nl;
+            in->pos = (size_t)(nl - in->data) + 1;
+            return 1;
+        }
+        if (in->eof || !refill(in)) {
+            if (in->pos == in->size) return 0;
+            *start = in->data + in->pos;
+            *end = in->data + in->size;
+            in->pos = in->size;
+            return 1;
+        }
+    }
+}
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Pula espaços e devolve o token seguinte em [*tok, *tok_end).
+static int next_token(const char** p, const char* end, const char** tok, const char** tok_end) {
+    while (*p < end && is_blank(**p)) (*p)++;
+    if (*p == end) return 0;
+    *tok = *p;
+    while (*p < end && !is_blank(**p)) (*p)++;
+    *tok_end = *p;
+    return 1;
+}
+
+static int parse_int(const char* p, const char* end, int* value) {
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    if (p == end) return 0;
+    long long v = 0;
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9') return 0;
+        v = v * 10 + (*p - '0');
+        if (v > (long long)INT_MAX + 1) return 0;
+    }
+    if (negative) v = -v;
+    if (v > INT_MAX || v < INT_MIN) return 0;
+    *value = (int)v;
+    return 1;
+}
+
+static int malformed(InputReader* in, const char* reason) {
+    fprintf(stderr, "escalona: linha %ld: %s\n", in->line, reason);
+    return -1;
+}
+
+int input_next(InputReader* in, Operation* op) {
+    const char* line;
+    const char* end;
+
+    while (next_line(in, &line, &end)) {
+        in->line++;
+
+        const char* p = line;
+        const char* tok[4];
+        const char* tok_end[4];
+        int count = 0;
+        while (count < 4 && next_token(&p, end, &tok[count], &tok_end[count])) count++;
+        if (count == 0) continue; // Linha em branco
+
+        const char* extra;
+        const char* extra_end;
+        if (count < 4) return malformed(in, "esperados 4 campos (tempo transação operação atributo)");
+        if (next_token(&p, end, &extra, &extra_end)) return malformed(in, "campos a mais");
+
+        if (!parse_int(tok[0], tok_end[0], &op->time)) return malformed(in, "tempo inválido");
+        if (!parse_int(tok[1], tok_end[1], &op->trans_id)) return malformed(in, "ID de transação inválido");
+        if (tok_end[2] - tok[2] != 1 || (*tok[2] != 'R' && *tok[2] != 'W' && *tok[2] != 'C')) {
+            return malformed(in, "operação inválida (esperado R, W ou C)");
+        }
+        op->op = *tok[2];
+        op->trans_idx = -1;
+        op->attr_idx = NO_ATTR;
+        if (tok_end[3] - tok[3] == 1 && *tok[3] == '-') {
+            op->attr = NO_ATTR;
+        } else {
+            op->attr = attr_intern(in->attrs, tok[3], (size_t)(tok_end[3] - tok[3]));
+            if (op->attr < 0) return malformed(in, "falha ao registrar o atributo");
+        }
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file entrada.h
+ * @brief Leitura rápida da entrada no formato "tempo transação operação atributo".
+ *
+ * Arquivos regulares (inclusive a entrada padrão redirecionada de um arquivo)
+ * são mapeados em memória, com leitura antecipada (MADV_WILLNEED) de uma
+ * janela à frente da posição atual; pipes são lidos em blocos grandes por
+ * uma thread própria, que preenche o próximo bloco enquanto o anterior é
+ * interpretado e analisado (fila circular sem trava). As linhas são
+ * divididas por um tokenizador próprio, sem scanf. Os nomes de atributo
+ * podem ser qualquer palavra sem espaços; o leitor os internaliza numa
+ * tabela (atributos.h) e entrega o ID global em Operation::attr.
+ */
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stddef.h>
+#include "algoritmos.h"
+
+/**
+ * @struct InputReader
+ * @brief Estado da leitura de uma entrada.
+ * @var InputReader::fd Descritor do arquivo lido.
+ * @var InputReader::data Início dos dados disponíveis (mapa ou buffer).
+ * @var InputReader::size Quantidade de bytes disponíveis em data.
+ * @var InputReader::pos Posição da próxima linha em data.
+ * @var InputReader::mapped Indica se data é um mapeamento do arquivo inteiro.
+ * @var InputReader::buffer Buffer de blocos, usado quando não há mapeamento.
+ * @var InputReader::buffer_capacity Capacidade do buffer.
+ * @var InputReader::eof Indica que o descritor não tem mais dados.
+ * @var InputReader::line Número da última linha lida (começando em 1).
+ * @var InputReader::attrs Tabela de nomes dos atributos lidos.
+ * @var InputReader::advised Fim da janela do mapa já pedida ao sistema.
+ * @var InputReader::prefetch Thread de leitura antecipada dos blocos (NULL = leitura direta).
+ */
+typedef struct {
+    int fd;
+    const char* data;
+    size_t size;
+    size_t pos;
+    int mapped;
+    char* buffer;
+    size_t buffer_capacity;
+    int eof;
+    long line;
+    AttrTable* attrs;
+    size_t advised;
+    struct InputPrefetch* prefetch;
+} InputReader;
+
+/**
+ * @brief Abre uma entrada para leitura.
+ * @param path Caminho do arquivo, ou NULL para a entrada padrão.
+ * @return O leitor criado, ou NULL em caso de erro (já reportado).
+ */
+InputReader* input_open(const char* path);
+
+/**
+ * @brief Lê a próxima operação da entrada.
+ *
+ * Linhas em branco são ignoradas. Uma linha mal formada é reportada na
+ * saída de erro com o seu número.
+ *
+ * @param in O leitor.
+ * @param op Recebe a operação lida (trans_idx e attr_idx ficam -1; o
+ *           atributo "-" vira NO_ATTR).
+ * @return 1 se leu uma operação, 0 no fim da entrada, -1 em linha mal formada.
+ */
+int input_next(InputReader* in, Operation* op);
+
+/**
+ * @brief Fecha a entrada e libera o leitor.
+ * @param in O leitor.
+ */
+void input_close(InputReader* in);
+
+#endif // ENTRADA_H
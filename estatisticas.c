@@ -0,0 +1,134 @@
+/**
+ * @file estatisticas.c
+ * @brief Implementação dos contadores e do relatório de --stats.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "estatisticas.h"
+
+// Faixas do histograma de latência: a faixa b cobre [2^(b-1), 2^b) µs.
+#define STATS_BUCKETS 32
+
+typedef struct {
+    long long phase_ns[STAT_PHASES];
+    long long counters[STAT_COUNTERS];
+} StatValues;
+
+typedef struct {
+    int schedule_id;
+    long long latency_ns;
+} StatSlow;
+
+static int enabled = 0;
+static _Thread_local StatValues thread_values;
+
+// Totais, protegidos por lock
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static StatValues totals;
+static long schedules = 0;
+static long long latency_total = 0;
+static long histogram[STATS_BUCKETS];
+static StatSlow slowest[STATS_SLOWEST];
+static int slowest_count = 0;
+
+static const char* phase_names[STAT_PHASES] = {
+    "leitura", "transacoes", "grafo", "ciclo", "visao"
+};
+
+void stats_enable(void) {
+    enabled = 1;
+}
+
+int stats_enabled(void) {
+    return enabled;
+}
+
+long long stats_clock(void) {
+    if (!enabled) return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+long long stats_phase(StatPhase phase, long long start) {
+    if (!enabled) return 0;
+    long long now = stats_clock();
+    thread_values.phase_ns[phase] += now - start;
+    return now;
+}
+
+void stats_add(StatCounter counter, long long amount) {
+    if (enabled) thread_values.counters[counter] += amount;
+}
+
+// Junta os valores da thread atual aos totais (com o lock já tomado).
+static void merge_thread_values(void) {
+    for (int p = 0; p < STAT_PHASES; p++) totals.phase_ns[p] += thread_values.phase_ns[p];
+    for (int c = 0; c < STAT_COUNTERS; c++) totals.counters[c] += thread_values.counters[c];
+    memset(&thread_values, 0, sizeof(thread_values));
+}
+
+static int latency_bucket(long long latency_ns) {
+    long long us = latency_ns / 1000;
+    int b = 0;
+    while (us > 0 && b < STATS_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void stats_record_schedule(int schedule_id, long long latency_ns) {
+    if (!enabled) return;
+    pthread_mutex_lock(&lock);
+    merge_thread_values();
+    schedules++;
+    latency_total += latency_ns;
+    histogram[latency_bucket(latency_ns)]++;
+
+    // Lista dos mais lentos, em ordem decrescente (inserção)
+    int pos = slowest_count < STATS_SLOWEST ? slowest_count++ : STATS_SLOWEST;
+    while (pos > 0 && slowest[pos - 1].latency_ns < latency_ns) {
+        if (pos < STATS_SLOWEST) slowest[pos] = slowest[pos - 1];
+        pos--;
+    }
+    if (pos < STATS_SLOWEST) slowest[pos] = (StatSlow){schedule_id, latency_ns};
+    pthread_mutex_unlock(&lock);
+}
+
+void stats_report(FILE* out) {
+    if (!enabled) return;
+    pthread_mutex_lock(&lock);
+    merge_thread_values();
+
+    fprintf(out, "escalona: estatísticas de %ld escalonamentos\n", schedules);
+    for (int p = 0; p < STAT_PHASES; p++) {
+        fprintf(out, "  fase %-10s %12.3f ms\n", phase_names[p], totals.phase_ns[p] / 1e6);
+    }
+    fprintf(out, "  arestas adicionadas %lld\n", totals.counters[STAT_EDGES]);
+    fprintf(out, "  visitas da DFS %lld\n", totals.counters[STAT_DFS_VISITS]);
+    fprintf(out, "  permutações: %lld prefixos testados, %lld podados\n",
+            totals.counters[STAT_PERMS_TRIED], totals.counters[STAT_PERMS_PRUNED]);
+    fprintf(out, "  polígrafo: %lld decisões, %lld retrocessos\n",
+            totals.counters[STAT_POLY_DECISIONS], totals.counters[STAT_POLY_BACKTRACKS]);
+
+    fprintf(out, "  latência por escalonamento (média %.3f µs):\n",
+            schedules ? latency_total / 1e3 / schedules : 0.0);
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        if (!histogram[b]) continue;
+        long long low = b ? 1LL << (b - 1) : 0;
+        if (b == STATS_BUCKETS - 1) {
+            fprintf(out, "    [%lld, ...) µs %ld\n", low, histogram[b]);
+        } else {
+            fprintf(out, "    [%lld, %lld) µs %ld\n", low, 1LL << b, histogram[b]);
+        }
+    }
+    fprintf(out, "  mais lentos:");
+    for (int i = 0; i < slowest_count; i++) {
+        fprintf(out, " %d (%.3f ms)", slowest[i].schedule_id, slowest[i].latency_ns / 1e6);
+    }
+    fprintf(out, "\n");
+    pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file estatisticas.h
+ * @brief Contadores e tempos por fase da análise (opção --stats).
+ *
+ * Os algoritmos acumulam tempos e contadores em variáveis da própria thread,
+ * sem travas. Ao fim de cada escalonamento, stats_record_schedule junta os
+ * valores da thread ao total e registra a latência do escalonamento no
+ * histograma e na lista dos mais lentos.
+ *
+ * Com as estatísticas desligadas (o padrão), stats_clock devolve 0 sem ler o
+ * relógio e as demais funções retornam de imediato.
+ */
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdio.h>
+
+// Quantidade de escalonamentos mais lentos listados no relatório.
+#define STATS_SLOWEST 10
+
+/**
+ * @brief Fases cronometradas.
+ */
+typedef enum {
+    STAT_PARSE,   // Leitura e corte da entrada em escalonamentos
+    STAT_UNIQUE,  // find_unique_transactions
+    STAT_GRAPH,   // Construção do grafo de precedência
+    STAT_CYCLE,   // Busca de ciclo / ordem topológica
+    STAT_VIEW,    // Teste por visão (tabelas, polígrafo e permutações)
+    STAT_PHASES
+} StatPhase;
+
+/**
+ * @brief Contadores de trabalho.
+ */
+typedef enum {
+    STAT_EDGES,          // Chamadas a add_edge no grafo de precedência
+    STAT_DFS_VISITS,     // Vértices visitados pela DFS
+    STAT_PERMS_TRIED,    // Prefixos de permutação estendidos na busca
+    STAT_PERMS_PRUNED,   // Extensões de prefixo descartadas por restrição
+    STAT_POLY_DECISIONS, // Escolhas do polígrafo decididas por backtracking
+    STAT_POLY_BACKTRACKS,// Escolhas do polígrafo trocadas após contradição
+    STAT_COUNTERS
+} StatCounter;
+
+/**
+ * @brief Liga a coleta. Deve ser chamada antes de iniciar as threads.
+ */
+void stats_enable(void);
+
+/**
+ * @brief Indica se a coleta está ligada.
+ * @return 1 se ligada, 0 caso contrário.
+ */
+int stats_enabled(void);
+
+/**
+ * @brief Instante atual, para cronometrar uma fase.
+ * @return Nanossegundos de um relógio monotônico, ou 0 com a coleta desligada.
+ */
+long long stats_clock(void);
+
+/**
+ * @brief Soma à fase o tempo decorrido desde start, na thread atual.
+ * @param phase A fase.
+ * @param start Instante devolvido por stats_clock.
+ * @return O instante atual (para cronometrar a fase seguinte), ou 0 com a
+ *         coleta desligada.
+ */
+long long stats_phase(StatPhase phase, long long start);
+
+/**
+ * @brief Soma um valor a um contador, na thread atual.
+ * @param counter O contador.
+ * @param amount O valor a somar.
+ */
+void stats_add(StatCounter counter, long long amount);
+
+/**
+ * @brief Junta os valores da thread atual ao total e registra a latência.
+ * @param schedule_id O identificador do escalonamento.
+ * @param latency_ns O tempo total de análise do escalonamento.
+ */
+void stats_record_schedule(int schedule_id, long long latency_ns);
+
+/**
+ * @brief Imprime o relatório (fases, contadores, histograma e mais lentos).
+ *
+ * Junta antes os valores ainda pendentes da thread atual.
+ *
+ * @param out Onde imprimir.
+ */
+void stats_report(FILE* out);
+
+#endif // ESTATISTICAS_H
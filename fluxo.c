@@ -0,0 +1,561 @@
+/**
+ * @file fluxo.c
+ * @brief Implementação do teste incremental de seriabilidade por conflito.
+ *
+ * Cada transação viva ocupa um vértice (posições reaproveitadas por uma
+ * lista livre). Referências guardadas por atributo levam a geração do
+ * vértice, de modo que uma posição reaproveitada não é confundida com a
+ * transação descartada que a ocupava.
+ *
+ * Arestas por atributo: uma leitura depende do último escritor; uma escrita
+ * depende do último escritor e dos leitores desde essa escrita. As arestas
+ * de escritores e leitores mais antigos são implicadas transitivamente por
+ * essas, então a alcançabilidade (e portanto os ciclos) é a mesma do grafo
+ * de precedência completo.
+ *
+ * Para o teste por visão, o fluxo guarda por transação ativa quais
+ * atributos ela leu e escreveu, o que basta para detectar escritas cegas ou
+ * repetidas e leituras que nenhum serial reproduz (as mesmas condições de
+ * is_view_serializable). Essas marcas são descartadas no commit. Depois de
+ * um ciclo, o grafo é descartado inteiro: o veredito por conflito não muda
+ * mais e só as marcas continuam sendo mantidas.
+ *
+ * O estado de um atributo também sai quando o último vértice que ele
+ * referencia (como último escritor ou leitor) é descartado: a posição volta
+ * para uma lista livre. Assim a memória acompanha as transações vivas, e não
+ * todos os atributos já vistos no escalonamento.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "fluxo.h"
+
+// Marcas de acesso de uma transação a um atributo.
+#define ACCESS_READ 1
+#define ACCESS_WRITTEN 2
+
+// --- Tabela hash com sondagem linear e remoção por deslocamento ---
+
+typedef struct {
+    int64_t* keys;
+    int* values;
+    unsigned char* used;
+    size_t mask;
+    size_t count;
+} LongMap;
+
+static size_t hash_long(int64_t key) {
+    uint64_t x = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+    return (size_t)(x ^ (x >> 29));
+}
+
+static int longmap_init(LongMap* m, size_t capacity) {
+    m->mask = capacity - 1;
+    m->count = 0;
+    m->keys = (int64_t*)malloc(capacity * sizeof(int64_t));
+    m->values = (int*)malloc(capacity * sizeof(int));
+    m->used = (unsigned char*)calloc(capacity, 1);
+    if (!m->keys || !m->values || !m->used) {
+        free(m->keys);
+        free(m->values);
+        free(m->used);
+        return 0;
+    }
+    return 1;
+}
+
+static void longmap_free(LongMap* m) {
+    free(m->keys);
+    free(m->values);
+    free(m->used);
+}
+
+// Posição da chave, ou da posição vazia onde ela entraria.
+static size_t longmap_slot(const LongMap* m, int64_t key) {
+    size_t i = hash_long(key) & m->mask;
+    while (m->used[i] && m->keys[i] != key) i = (i + 1) & m->mask;
+    return i;
+}
+
+static int* longmap_find(const LongMap* m, int64_t key) {
+    size_t i = longmap_slot(m, key);
+    return m->used[i] ? &m->values[i] : NULL;
+}
+
+static int longmap_grow(LongMap* m) {
+    LongMap bigger;
+    if (!longmap_init(&bigger, (m->mask + 1) * 2)) return 0;
+    for (size_t i = 0; i <= m->mask; i++) {
+        if (!m->used[i]) continue;
+        size_t j = longmap_slot(&bigger, m->keys[i]);
+        bigger.used[j] = 1;
+        bigger.keys[j] = m->keys[i];
+        bigger.values[j] = m->values[i];
+    }
+    bigger.count = m->count;
+    longmap_free(m);
+    *m = bigger;
+    return 1;
+}
+
+// Insere a chave se ausente. Retorna 1 se inseriu, 0 se já existia, -1 em erro.
+static int longmap_insert(LongMap* m, int64_t key, int value) {
+    if ((m->count + 1) * 2 > m->mask + 1 && !longmap_grow(m)) return -1;
+    size_t i = longmap_slot(m, key);
+    if (m->used[i]) return 0;
+    m->used[i] = 1;
+    m->keys[i] = key;
+    m->values[i] = value;
+    m->count++;
+    return 1;
+}
+
+static void longmap_remove(LongMap* m, int64_t key) {
+    size_t i = longmap_slot(m, key);
+    if (!m->used[i]) return;
+    // Desloca para trás as chaves seguintes do mesmo agrupamento
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & m->mask;
+        if (!m->used[j]) break;
+        size_t home = hash_long(m->keys[j]) & m->mask;
+        // j só pode ocupar i se i estiver no caminho circular home..j
+        if (((j - home) & m->mask) >= ((j - i) & m->mask)) {
+            m->keys[i] = m->keys[j];
+            m->values[i] = m->values[j];
+            i = j;
+        }
+    }
+    m->used[i] = 0;
+    m->count--;
+}
+
+// --- Estado do fluxo ---
+
+// Referência a um vértice; inválida quando a geração do vértice mudou.
+typedef struct {
+    int slot;
+    unsigned gen;
+} TransRef;
+
+typedef struct {
+    int trans_id;
+    unsigned gen;
+    int live;
+    int committed;
+    int in_degree;   // Arestas vindas de vértices vivos
+    int* out;        // Sucessores (sem repetição)
+    int out_count;
+    int out_capacity;
+    int* touched;    // Atributos acessados (com marca em access até o commit)
+    int touched_count;
+    int touched_capacity;
+} StreamVertex;
+
+typedef struct {
+    int attr_id;         // ID global (NO_ATTR se a posição está livre)
+    TransRef writer;     // Último escritor (slot -1 se nenhum)
+    TransRef* readers;   // Leitores desde a última escrita
+    int reader_count;
+    int reader_capacity;
+} AttrState;
+
+struct ConflictStream {
+    StreamVertex* vertices;
+    int vertex_capacity;
+    int* free_slots;
+    int free_count;
+    int live_count;
+
+    LongMap trans_map;  // trans_id -> posição do vértice
+    LongMap edges;      // (origem << 32 | destino) das arestas vivas
+    LongMap access;     // (vértice << 32 | atributo) -> ACCESS_*, só de transações ativas
+
+    // Estado por atributo, num vetor denso com posições reaproveitadas
+    LongMap attr_map;   // ID global do atributo -> posição em attrs
+    AttrState* attrs;
+    int attr_count;     // Posições já usadas alguma vez
+    int attr_capacity;
+    int* attr_free;     // Posições liberadas, reaproveitadas antes de crescer
+    int attr_free_count;
+
+    long op_count;
+    long violation_op;  // 0 enquanto não houver ciclo
+    int blind_writes;   // Alguma escrita cega ou repetida do mesmo atributo
+    int impossible;     // Alguma leitura que nenhum serial reproduz
+
+    // Busca de alcançabilidade e descarte em cascata
+    unsigned* visit_stamp;
+    unsigned stamp;
+    int* stack;
+};
+
+static int64_t edge_key(int from, int to) {
+    return ((int64_t)from << 32) | (uint32_t)to;
+}
+
+static int ref_valid(const ConflictStream* cs, TransRef r) {
+    return r.slot >= 0 && cs->vertices[r.slot].live && cs->vertices[r.slot].gen == r.gen;
+}
+
+ConflictStream* stream_begin(void) {
+    ConflictStream* cs = (ConflictStream*)calloc(1, sizeof(ConflictStream));
+    if (!cs) {
+        perror("Falha ao alocar fluxo");
+        return NULL;
+    }
+    int ok_trans = longmap_init(&cs->trans_map, 64);
+    int ok_edges = longmap_init(&cs->edges, 256);
+    int ok_access = longmap_init(&cs->access, 256);
+    int ok_attrs = longmap_init(&cs->attr_map, 64);
+    if (!ok_trans || !ok_edges || !ok_access || !ok_attrs) {
+        perror("Falha ao alocar fluxo");
+        if (ok_trans) longmap_free(&cs->trans_map);
+        if (ok_edges) longmap_free(&cs->edges);
+        if (ok_access) longmap_free(&cs->access);
+        if (ok_attrs) longmap_free(&cs->attr_map);
+        free(cs);
+        return NULL;
+    }
+    return cs;
+}
+
+void stream_end(ConflictStream* cs) {
+    if (!cs) return;
+    for (int i = 0; i < cs->vertex_capacity; i++) {
+        free(cs->vertices[i].out);
+        free(cs->vertices[i].touched);
+    }
+    for (int a = 0; a < cs->attr_count; a++) free(cs->attrs[a].readers);
+    free(cs->attrs);
+    free(cs->attr_free);
+    longmap_free(&cs->attr_map);
+    free(cs->vertices);
+    free(cs->free_slots);
+    free(cs->visit_stamp);
+    free(cs->stack);
+    longmap_free(&cs->trans_map);
+    longmap_free(&cs->edges);
+    longmap_free(&cs->access);
+    free(cs);
+}
+
+int stream_verdict_so_far(const ConflictStream* cs) {
+    return cs->violation_op == 0;
+}
+
+long stream_violation(const ConflictStream* cs) {
+    return cs->violation_op;
+}
+
+int stream_view_verdict_so_far(const ConflictStream* cs) {
+    if (!cs->violation_op) return 1;
+    // Sem escritas cegas ou repetidas, visão e conflito coincidem
+    if (!cs->blind_writes || cs->impossible) return 0;
+    return -1;
+}
+
+int stream_live_transactions(const ConflictStream* cs) {
+    return cs->live_count;
+}
+
+// Estado do atributo de ID global 'attr', criado no primeiro acesso. NULL em erro.
+static AttrState* attr_state(ConflictStream* cs, int attr) {
+    int* found = longmap_find(&cs->attr_map, attr);
+    if (found) return &cs->attrs[*found];
+
+    if (cs->attr_free_count == 0 && cs->attr_count >= cs->attr_capacity) {
+        int cap = cs->attr_capacity ? cs->attr_capacity * 2 : 16;
+        AttrState* attrs = (AttrState*)realloc(cs->attrs, cap * sizeof(AttrState));
+        if (attrs) cs->attrs = attrs;
+        int* attr_free = (int*)realloc(cs->attr_free, cap * sizeof(int));
+        if (attr_free) cs->attr_free = attr_free;
+        if (!attrs || !attr_free) return NULL;
+        cs->attr_capacity = cap;
+    }
+    int pos = cs->attr_free_count ? cs->attr_free[cs->attr_free_count - 1] : cs->attr_count;
+    if (longmap_insert(&cs->attr_map, attr, pos) < 0) return NULL;
+    if (cs->attr_free_count) cs->attr_free_count--;
+    else cs->attr_count++;
+    AttrState* a = &cs->attrs[pos];
+    *a = (AttrState){attr, {-1, 0}, NULL, 0, 0};
+    return a;
+}
+
+// Libera o estado do atributo se nenhum vértice vivo é referenciado por ele
+// (um estado novo se comportaria igual).
+static void release_attr_if_unused(ConflictStream* cs, int attr) {
+    int* found = longmap_find(&cs->attr_map, attr);
+    if (!found) return;
+    AttrState* a = &cs->attrs[*found];
+    if (ref_valid(cs, a->writer)) return;
+    int kept = 0;
+    for (int i = 0; i < a->reader_count; i++) {
+        if (ref_valid(cs, a->readers[i])) a->readers[kept++] = a->readers[i];
+    }
+    a->reader_count = kept;
+    if (kept > 0) return;
+
+    cs->attr_free[cs->attr_free_count++] = *found;
+    longmap_remove(&cs->attr_map, attr);
+    free(a->readers);
+    *a = (AttrState){NO_ATTR, {-1, 0}, NULL, 0, 0};
+}
+
+// Dobra os vetores indexados por vértice.
+static int grow_vertices(ConflictStream* cs) {
+    int cap = cs->vertex_capacity ? cs->vertex_capacity * 2 : 16;
+    StreamVertex* v = (StreamVertex*)realloc(cs->vertices, cap * sizeof(StreamVertex));
+    if (v) cs->vertices = v;
+    int* f = (int*)realloc(cs->free_slots, cap * sizeof(int));
+    if (f) cs->free_slots = f;
+    unsigned* st = (unsigned*)realloc(cs->visit_stamp, cap * sizeof(unsigned));
+    if (st) cs->visit_stamp = st;
+    int* s = (int*)realloc(cs->stack, cap * sizeof(int));
+    if (s) cs->stack = s;
+    if (!v || !f || !st || !s) return 0;
+
+    for (int i = cs->vertex_capacity; i < cap; i++) {
+        cs->vertices[i] = (StreamVertex){0};
+        cs->visit_stamp[i] = 0;
+    }
+    // Posições novas entram na lista livre, as de menor índice no topo
+    for (int i = cap - 1; i >= cs->vertex_capacity; i--) {
+        cs->free_slots[cs->free_count++] = i;
+    }
+    cs->vertex_capacity = cap;
+    return 1;
+}
+
+// Posição do vértice da transação, criando-o se necessário. -1 em erro.
+static int vertex_for(ConflictStream* cs, int trans_id) {
+    int* found = longmap_find(&cs->trans_map, trans_id);
+    if (found) return *found;
+
+    if (cs->free_count == 0 && !grow_vertices(cs)) return -1;
+    int slot = cs->free_slots[--cs->free_count];
+    if (longmap_insert(&cs->trans_map, trans_id, slot) < 0) {
+        cs->free_count++;
+        return -1;
+    }
+    StreamVertex* v = &cs->vertices[slot];
+    v->trans_id = trans_id;
+    v->live = 1;
+    v->committed = 0;
+    v->in_degree = 0;
+    v->out_count = 0;
+    v->touched_count = 0;
+    cs->live_count++;
+    return slot;
+}
+
+// Verifica se 'from' alcança 'target' pelas arestas vivas (DFS iterativa).
+static int reaches(ConflictStream* cs, int from, int target) {
+    if (++cs->stamp == 0) {
+        // Estouro do carimbo: recomeça com todas as marcas zeradas
+        for (int i = 0; i < cs->vertex_capacity; i++) cs->visit_stamp[i] = 0;
+        cs->stamp = 1;
+    }
+    int top = 0;
+    cs->stack[top++] = from;
+    cs->visit_stamp[from] = cs->stamp;
+    while (top > 0) {
+        const StreamVertex* v = &cs->vertices[cs->stack[--top]];
+        for (int i = 0; i < v->out_count; i++) {
+            int w = v->out[i];
+            if (w == target) return 1;
+            if (cs->visit_stamp[w] != cs->stamp) {
+                cs->visit_stamp[w] = cs->stamp;
+                cs->stack[top++] = w;
+            }
+        }
+    }
+    return 0;
+}
+
+// Insere a aresta from -> to e verifica se ela fecha um ciclo. 0 em erro.
+static int stream_add_edge(ConflictStream* cs, int from, int to) {
+    int inserted = longmap_insert(&cs->edges, edge_key(from, to), 0);
+    if (inserted <= 0) return inserted == 0;
+
+    StreamVertex* u = &cs->vertices[from];
+    if (u->out_count >= u->out_capacity) {
+        int cap = u->out_capacity ? u->out_capacity * 2 : 4;
+        int* out = (int*)realloc(u->out, cap * sizeof(int));
+        if (!out) {
+            longmap_remove(&cs->edges, edge_key(from, to));
+            return 0;
+        }
+        u->out = out;
+        u->out_capacity = cap;
+    }
+
+    // Só há ciclo se 'to' já alcançava 'from'; sem arestas de entrada em
+    // 'from' ou de saída em 'to', isso é impossível
+    if (cs->violation_op == 0 && u->in_degree > 0 && cs->vertices[to].out_count > 0 &&
+        reaches(cs, to, from)) {
+        cs->violation_op = cs->op_count;
+    }
+    u->out[u->out_count++] = to;
+    cs->vertices[to].in_degree++;
+    return 1;
+}
+
+// Libera a posição de um vértice já sem arestas de saída, junto com os
+// atributos que só o referenciavam.
+static void release_vertex(ConflictStream* cs, int slot) {
+    StreamVertex* v = &cs->vertices[slot];
+    longmap_remove(&cs->trans_map, v->trans_id);
+    v->out_count = 0;
+    v->live = 0;
+    v->gen++;
+    cs->free_slots[cs->free_count++] = slot;
+    cs->live_count--;
+    for (int i = 0; i < v->touched_count; i++) release_attr_if_unused(cs, v->touched[i]);
+    v->touched_count = 0;
+}
+
+// Descarta o grafo inteiro depois de um ciclo; as transações que já fizeram
+// commit saem junto, as ativas continuam só pelas marcas de acesso.
+static void drop_graph(ConflictStream* cs) {
+    memset(cs->edges.used, 0, cs->edges.mask + 1);
+    cs->edges.count = 0;
+    for (int a = 0; a < cs->attr_count; a++) cs->attrs[a].reader_count = 0;
+    for (int i = 0; i < cs->vertex_capacity; i++) {
+        StreamVertex* v = &cs->vertices[i];
+        if (!v->live) continue;
+        v->out_count = 0;
+        v->in_degree = 0;
+        if (v->committed) release_vertex(cs, i);
+    }
+}
+
+// Descarta o vértice e, em cascata, os sucessores que ficarem descartáveis.
+static void prune(ConflictStream* cs, int slot) {
+    int top = 0;
+    cs->stack[top++] = slot;
+    while (top > 0) {
+        int x = cs->stack[--top];
+        StreamVertex* v = &cs->vertices[x];
+        for (int i = 0; i < v->out_count; i++) {
+            int y = v->out[i];
+            longmap_remove(&cs->edges, edge_key(x, y));
+            StreamVertex* w = &cs->vertices[y];
+            // Cada vértice entra na pilha uma única vez: quando chega a grau zero
+            if (--w->in_degree == 0 && w->committed) cs->stack[top++] = y;
+        }
+        release_vertex(cs, x);
+    }
+}
+
+// Registra o acesso da transação ao atributo e atualiza as marcas do teste
+// por visão. 0 em erro.
+static int track_access(ConflictStream* cs, int slot, int attr, char op, const AttrState* a) {
+    int64_t key = ((int64_t)slot << 32) | (uint32_t)attr;
+    int* flags = longmap_find(&cs->access, key);
+    if (!flags) {
+        StreamVertex* v = &cs->vertices[slot];
+        if (v->touched_count >= v->touched_capacity) {
+            int cap = v->touched_capacity ? v->touched_capacity * 2 : 4;
+            int* touched = (int*)realloc(v->touched, cap * sizeof(int));
+            if (!touched) return 0;
+            v->touched = touched;
+            v->touched_capacity = cap;
+        }
+        if (longmap_insert(&cs->access, key, 0) < 0) return 0;
+        v->touched[v->touched_count++] = attr;
+        flags = longmap_find(&cs->access, key);
+    }
+
+    if (op == 'R') {
+        // Depois da própria escrita, só pode ler de si mesma em qualquer serial
+        if ((*flags & ACCESS_WRITTEN) && a->writer.slot != slot) cs->impossible = 1;
+        *flags |= ACCESS_READ;
+    } else {
+        if (!(*flags & ACCESS_READ) || (*flags & ACCESS_WRITTEN)) cs->blind_writes = 1;
+        *flags |= ACCESS_WRITTEN;
+    }
+    return 1;
+}
+
+// Acrescenta um leitor, compactando referências mortas antes de crescer.
+static int add_reader(ConflictStream* cs, AttrState* a, TransRef r) {
+    if (a->reader_count > 0) {
+        TransRef last = a->readers[a->reader_count - 1];
+        if (last.slot == r.slot && last.gen == r.gen) return 1;
+    }
+    if (a->reader_count >= a->reader_capacity) {
+        int kept = 0;
+        for (int i = 0; i < a->reader_count; i++) {
+            if (ref_valid(cs, a->readers[i])) a->readers[kept++] = a->readers[i];
+        }
+        a->reader_count = kept;
+    }
+    if (a->reader_count >= a->reader_capacity) {
+        int cap = a->reader_capacity ? a->reader_capacity * 2 : 4;
+        TransRef* readers = (TransRef*)realloc(a->readers, cap * sizeof(TransRef));
+        if (!readers) return 0;
+        a->readers = readers;
+        a->reader_capacity = cap;
+    }
+    a->readers[a->reader_count++] = r;
+    return 1;
+}
+
+int stream_feed(ConflictStream* cs, const Operation* op) {
+    cs->op_count++;
+    int slot = vertex_for(cs, op->trans_id);
+    if (slot < 0) {
+        perror("Falha ao alocar vértice do fluxo");
+        return -1;
+    }
+    StreamVertex* v = &cs->vertices[slot];
+    TransRef self = {slot, v->gen};
+    AttrState* a = NULL;
+    if ((op->op == 'R' || op->op == 'W') && op->attr != NO_ATTR && !(a = attr_state(cs, op->attr))) {
+        perror("Falha ao alocar atributo do fluxo");
+        return -1;
+    }
+    // Depois de um ciclo o grafo já foi descartado e não recebe mais arestas
+    int graph = cs->violation_op == 0;
+    int ok = 1;
+
+    // Leituras e escritas sem atributo (a == NULL) não geram conflitos
+    if (op->op == 'R' && a) {
+        ok = track_access(cs, slot, op->attr, op->op, a);
+        if (ok && graph && ref_valid(cs, a->writer) && a->writer.slot != slot) {
+            ok = stream_add_edge(cs, a->writer.slot, slot);
+        }
+        ok = ok && (!graph || add_reader(cs, a, self));
+    } else if (op->op == 'W' && a) {
+        ok = track_access(cs, slot, op->attr, op->op, a);
+        if (ok && graph && ref_valid(cs, a->writer) && a->writer.slot != slot) {
+            ok = stream_add_edge(cs, a->writer.slot, slot);
+        }
+        for (int i = 0; ok && graph && i < a->reader_count; i++) {
+            if (ref_valid(cs, a->readers[i]) && a->readers[i].slot != slot) {
+                ok = stream_add_edge(cs, a->readers[i].slot, slot);
+            }
+        }
+        a->reader_count = 0;
+        a->writer = self;
+    } else if (op->op == 'C') {
+        // Sem operações futuras, as marcas de acesso da transação não servem mais
+        // (a lista touched fica até o descarte, que libera os atributos)
+        StreamVertex* c = &cs->vertices[slot];
+        for (int i = 0; i < c->touched_count; i++) {
+            longmap_remove(&cs->access, ((int64_t)slot << 32) | (uint32_t)c->touched[i]);
+        }
+        c->committed = 1;
+        if (c->in_degree == 0) prune(cs, slot);
+    }
+
+    if (ok && graph && cs->violation_op) drop_graph(cs);
+
+    if (!ok) {
+        perror("Falha ao alocar aresta do fluxo");
+        return -1;
+    }
+    return stream_verdict_so_far(cs);
+}
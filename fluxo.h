@@ -0,0 +1,92 @@
+/**
+ * @file fluxo.h
+ * @brief Teste incremental de seriabilidade por conflito sobre um fluxo de operações.
+ *
+ * Em vez de esperar o escalonamento fechar, mantém o grafo de precedência
+ * operação a operação. A cada aresta nova, verifica apenas se o destino já
+ * alcança a origem; assim o ciclo é detectado exatamente na operação que o
+ * fecha.
+ *
+ * Transações que já fizeram commit e não têm arestas de entrada nunca mais
+ * podem entrar em um ciclo: uma aresta nova para elas exigiria uma operação
+ * posterior ao commit. Elas são descartadas (em cascata), junto com o estado
+ * dos atributos que só elas referenciavam, e a memória do fluxo fica
+ * proporcional às transações que ainda podem participar de um ciclo.
+ *
+ * O fluxo também acompanha o teste por visão até onde isso é possível sem o
+ * histórico: escritas cegas ou repetidas e leituras que nenhum serial
+ * reproduz (ver stream_view_verdict_so_far).
+ */
+#ifndef FLUXO_H
+#define FLUXO_H
+
+#include "algoritmos.h"
+
+/**
+ * @struct ConflictStream
+ * @brief Estado opaco do teste incremental.
+ */
+typedef struct ConflictStream ConflictStream;
+
+/**
+ * @brief Inicia um fluxo vazio.
+ * @return O fluxo criado, ou NULL em caso de falha de alocação.
+ */
+ConflictStream* stream_begin(void);
+
+/**
+ * @brief Acrescenta uma operação ao fluxo.
+ *
+ * Usa apenas trans_id, op e attr de op; trans_idx é ignorado. Quem chama
+ * não deve passar operações de uma transação depois do seu commit: o vértice
+ * dela pode já ter sido descartado, e o mesmo ID voltaria como uma transação
+ * nova, sem as arestas antigas.
+ *
+ * @param cs O fluxo.
+ * @param op A operação, na ordem de chegada.
+ * @return 1 se o fluxo continua serializável, 0 se há ciclo (fechado
+ *         nesta operação ou antes), -1 em caso de falha de alocação.
+ */
+int stream_feed(ConflictStream* cs, const Operation* op);
+
+/**
+ * @brief Veredito do teste por conflito para as operações vistas até agora.
+ * @param cs O fluxo.
+ * @return 1 se serializável por conflito até aqui, 0 caso contrário.
+ */
+int stream_verdict_so_far(const ConflictStream* cs);
+
+/**
+ * @brief Posição da operação que fechou o primeiro ciclo.
+ * @param cs O fluxo.
+ * @return O número da operação (1 = primeira recebida), ou 0 se não há ciclo.
+ */
+long stream_violation(const ConflictStream* cs);
+
+/**
+ * @brief Veredito do teste por visão para as operações vistas até agora.
+ *
+ * Serializável por conflito implica por visão. Fora isso, o veredito só é
+ * conhecido sem o histórico quando não há escritas cegas nem repetidas (visão
+ * e conflito coincidem) ou quando alguma leitura não é reproduzível.
+ *
+ * @param cs O fluxo.
+ * @return 1 se serializável por visão, 0 se não, -1 se só a busca sobre o
+ *         histórico completo decidiria.
+ */
+int stream_view_verdict_so_far(const ConflictStream* cs);
+
+/**
+ * @brief Número de transações ainda mantidas no grafo.
+ * @param cs O fluxo.
+ * @return As transações que não foram descartadas.
+ */
+int stream_live_transactions(const ConflictStream* cs);
+
+/**
+ * @brief Libera o fluxo.
+ * @param cs O fluxo (pode ser NULL).
+ */
+void stream_end(ConflictStream* cs);
+
+#endif // FLUXO_H
@@ -0,0 +1,197 @@
+/**
+ * @file gerador.c
+ * @brief Gerador de escalonamentos sintéticos para os benchmarks.
+ *
+ * Escreve na saída padrão escalonamentos no formato de entrada do escalona
+ * ("tempo transação operação atributo"). Cada escalonamento tem um número
+ * fixo de transações, intercaladas ao acaso, que só fazem commit depois da
+ * sua última operação. Os atributos seguem uma distribuição de Zipf (s = 0
+ * é uniforme; quanto maior s, mais disputados os primeiros atributos).
+ *
+ * Uma escrita é cega quando a transação não leu o atributo antes; as demais
+ * escritas saem como leitura seguida de escrita (ler-modificar-escrever).
+ * A mesma semente gera sempre a mesma saída.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @struct GenParams
+ * @brief Parâmetros da geração.
+ */
+typedef struct {
+    long schedules;        // Número de escalonamentos
+    int transactions;      // Transações por escalonamento
+    int ops;               // Operações (sem o commit) por transação
+    int attrs;             // Tamanho do domínio de atributos
+    double read_ratio;     // Fração das operações que são leituras
+    double blind_fraction; // Fração das escritas que são cegas
+    double zipf;           // Expoente da distribuição de Zipf
+    uint64_t seed;
+} GenParams;
+
+/**
+ * @struct GenTrans
+ * @brief Operações já sorteadas de uma transação.
+ */
+typedef struct {
+    char* kinds;  // 'R' ou 'W'
+    int* attrs;
+    int count;
+    int next;     // Próxima operação a emitir (count = só falta o commit)
+} GenTrans;
+
+static uint64_t rng_state;
+
+// xorshift64*: rápido e suficiente para sortear cargas.
+static uint64_t next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+// Número uniforme em [0, 1).
+static double next_unit(void) {
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Sorteia um atributo pela distribuição acumulada (busca binária).
+static int next_attr(const double* cdf, int attrs) {
+    double u = next_unit();
+    int lo = 0, hi = attrs - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cdf[mid] > u) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+// Sorteia as operações de uma transação; read_seen é uma área de marcas por atributo.
+static void fill_transaction(GenTrans* t, const GenParams* p, const double* cdf, int* read_seen, int stamp) {
+    t->count = 0;
+    t->next = 0;
+    while (t->count < p->ops) {
+        int a = next_attr(cdf, p->attrs);
+        if (next_unit() < p->read_ratio) {
+            t->kinds[t->count] = 'R';
+            t->attrs[t->count++] = a;
+            read_seen[a] = stamp;
+            continue;
+        }
+        // Escrita não cega: lê o atributo antes, se ainda couber na transação
+        if (read_seen[a] != stamp && next_unit() >= p->blind_fraction && t->count + 2 <= p->ops) {
+            t->kinds[t->count] = 'R';
+            t->attrs[t->count++] = a;
+            read_seen[a] = stamp;
+        }
+        t->kinds[t->count] = 'W';
+        t->attrs[t->count++] = a;
+    }
+}
+
+static void print_usage(const char* prog) {
+    fprintf(stderr, "Uso: %s [-n N] [-t N] [-o N] [-a N] [-r F] [-b F] [-z S] [-s SEMENTE]\n", prog);
+    fprintf(stderr, "  -n N   escalonamentos (padrão 1000)\n");
+    fprintf(stderr, "  -t N   transações por escalonamento (padrão 4)\n");
+    fprintf(stderr, "  -o N   operações por transação, sem o commit (padrão 4)\n");
+    fprintf(stderr, "  -a N   atributos distintos (padrão 16)\n");
+    fprintf(stderr, "  -r F   fração de leituras (padrão 0.5)\n");
+    fprintf(stderr, "  -b F   fração de escritas cegas (padrão 0.5)\n");
+    fprintf(stderr, "  -z S   expoente de Zipf da disputa por atributos (padrão 0, uniforme)\n");
+    fprintf(stderr, "  -s N   semente (padrão 1)\n");
+}
+
+int main(int argc, char** argv) {
+    GenParams p = {1000, 4, 4, 16, 0.5, 0.5, 0.0, 1};
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][2] != '\0') {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        const char* value = argv[++i];
+        switch (argv[i - 1][1]) {
+            case 'n': p.schedules = atol(value); break;
+            case 't': p.transactions = atoi(value); break;
+            case 'o': p.ops = atoi(value); break;
+            case 'a': p.attrs = atoi(value); break;
+            case 'r': p.read_ratio = atof(value); break;
+            case 'b': p.blind_fraction = atof(value); break;
+            case 'z': p.zipf = atof(value); break;
+            case 's': p.seed = strtoull(value, NULL, 10); break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (p.schedules < 0 || p.transactions < 1 || p.ops < 1 || p.attrs < 1 || p.zipf < 0) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    rng_state = p.seed ? p.seed : 1;
+
+    // Distribuição acumulada de Zipf: peso do atributo k é 1 / (k + 1)^s
+    double* cdf = (double*)malloc(p.attrs * sizeof(double));
+    int* read_seen = (int*)calloc(p.attrs, sizeof(int));
+    GenTrans* trans = (GenTrans*)calloc(p.transactions, sizeof(GenTrans));
+    int* active = (int*)malloc(p.transactions * sizeof(int));
+    if (!cdf || !read_seen || !trans || !active) {
+        perror("Falha ao alocar o gerador");
+        return EXIT_FAILURE;
+    }
+    double total = 0;
+    for (int k = 0; k < p.attrs; k++) {
+        total += 1.0 / pow(k + 1, p.zipf);
+        cdf[k] = total;
+    }
+    for (int k = 0; k < p.attrs; k++) cdf[k] /= total;
+    for (int t = 0; t < p.transactions; t++) {
+        trans[t].kinds = (char*)malloc(p.ops);
+        trans[t].attrs = (int*)malloc(p.ops * sizeof(int));
+        if (!trans[t].kinds || !trans[t].attrs) {
+            perror("Falha ao alocar o gerador");
+            return EXIT_FAILURE;
+        }
+    }
+
+    long time = 1;
+    long trans_base = 1;
+    int stamp = 0;
+    for (long n = 0; n < p.schedules; n++) {
+        for (int t = 0; t < p.transactions; t++) {
+            fill_transaction(&trans[t], &p, cdf, read_seen, ++stamp);
+            active[t] = t;
+        }
+
+        // Intercala as transações: a cada passo, uma ativa sorteada avança
+        int active_count = p.transactions;
+        while (active_count > 0) {
+            int pick = (int)(next_random() % (uint64_t)active_count);
+            GenTrans* t = &trans[active[pick]];
+            long id = trans_base + active[pick];
+            if (t->next < t->count) {
+                printf("%ld %ld %c a%d\n", time++, id, t->kinds[t->next], t->attrs[t->next]);
+                t->next++;
+            } else {
+                printf("%ld %ld C -\n", time++, id);
+                active[pick] = active[--active_count];
+            }
+        }
+        trans_base += p.transactions;
+    }
+
+    for (int t = 0; t < p.transactions; t++) {
+        free(trans[t].kinds);
+        free(trans[t].attrs);
+    }
+    free(trans);
+    free(active);
+    free(read_seen);
+    free(cdf);
+    return fflush(stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,118 +1,497 @@
-
 /**
  * @file graph.c
  * @brief Implementação das funções de manipulação de grafo.
  *
  * Contém a lógica para criar, destruir, adicionar arestas e detectar
- * ciclos em um grafo direcionado. A detecção de ciclo é feita com DFS.
+ * ciclos em um grafo direcionado. A detecção de ciclo é feita com DFS
+ * iterativa, com pilha explícita, para não estourar a pilha de chamadas em
+ * cadeias longas de transações.
  */
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 #include "grafo.h"
+#include "estatisticas.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GRAFO_X86_SIMD 1
+#endif
 
 // Enum para as cores dos vertices usadas na detecção de ciclo por DFS
 typedef enum { WHITE, GRAY, BLACK } Color;
 
-int has_cycle_util(Graph* g, int u, Color* color);
+
+// --- Operações sobre linhas de bits ---
+
+static int bitset_intersects_portable(const uint64_t* a, const uint64_t* b, int words) {
+    for (int i = 0; i < words; i++) {
+        if (a[i] & b[i]) return 1;
+    }
+    return 0;
+}
+
+static void bitset_or_portable(uint64_t* dst, const uint64_t* src, int words) {
+    for (int i = 0; i < words; i++) {
+        dst[i] |= src[i];
+    }
+}
+
+#ifdef GRAFO_X86_SIMD
+__attribute__((target("avx2")))
+static int bitset_intersects_avx2(const uint64_t* a, const uint64_t* b, int words) {
+    int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        if (!_mm256_testz_si256(va, vb)) return 1;
+    }
+    return bitset_intersects_portable(a + i, b + i, words - i);
+}
+
+__attribute__((target("avx2")))
+static void bitset_or_avx2(uint64_t* dst, const uint64_t* src, int words) {
+    int i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i vd = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i vs = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(vd, vs));
+    }
+    bitset_or_portable(dst + i, src + i, words - i);
+}
+
+__attribute__((target("sse2")))
+static int bitset_intersects_sse2(const uint64_t* a, const uint64_t* b, int words) {
+    int i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i vand = _mm_and_si128(va, vb);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(vand, _mm_setzero_si128())) != 0xFFFF) return 1;
+    }
+    return bitset_intersects_portable(a + i, b + i, words - i);
+}
+
+__attribute__((target("sse2")))
+static void bitset_or_sse2(uint64_t* dst, const uint64_t* src, int words) {
+    int i = 0;
+    for (; i + 2 <= words; i += 2) {
+        __m128i vd = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i vs = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(vd, vs));
+    }
+    bitset_or_portable(dst + i, src + i, words - i);
+}
+#endif
+
+// Implementações escolhidas na primeira chamada, conforme a CPU. Com -j
+// várias threads chegam aqui ao mesmo tempo: a escolha passa por pthread_once.
+static int (*intersects_impl)(const uint64_t*, const uint64_t*, int) = NULL;
+static void (*or_impl)(uint64_t*, const uint64_t*, int) = NULL;
+static pthread_once_t bitset_impl_once = PTHREAD_ONCE_INIT;
+
+static void select_bitset_impl(void) {
+    intersects_impl = bitset_intersects_portable;
+    or_impl = bitset_or_portable;
+#ifdef GRAFO_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        intersects_impl = bitset_intersects_avx2;
+        or_impl = bitset_or_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        intersects_impl = bitset_intersects_sse2;
+        or_impl = bitset_or_sse2;
+    }
+#endif
+}
+
+int bitset_intersects(const uint64_t* a, const uint64_t* b, int words) {
+    pthread_once(&bitset_impl_once, select_bitset_impl);
+    return intersects_impl(a, b, words);
+}
+
+void bitset_or(uint64_t* dst, const uint64_t* src, int words) {
+    pthread_once(&bitset_impl_once, select_bitset_impl);
+    or_impl(dst, src, words);
+}
 
 // --- Implementações ---
 
 Graph* create_graph(int num_vertices) {
+    return create_graph_mode(num_vertices, GRAPH_AUTO);
+}
+
+Graph* create_graph_mode(int num_vertices, GraphMode mode) {
+    return create_graph_in(NULL, num_vertices, mode);
+}
+
+Graph* create_graph_in(Arena* arena, int num_vertices, GraphMode mode) {
     if (num_vertices <= 0) return NULL;
 
-    Graph* g = (Graph*)malloc(sizeof(Graph));
+    if (mode == GRAPH_AUTO) {
+        mode = (num_vertices >= GRAPH_SPARSE_THRESHOLD) ? GRAPH_SPARSE : GRAPH_DENSE;
+    }
+
+    Graph* g = (Graph*)arena_calloc(arena, 1, sizeof(Graph));
     if (!g) {
         perror("Falha ao alocar memória para o grafo");
         return NULL;
     }
+    g->arena = arena;
     g->num_vertices = num_vertices;
+    g->mode = mode;
 
-    g->matrix = (int**)malloc(num_vertices * sizeof(int*));
-    if (!g->matrix) {
-        perror("Falha ao alocar memória para as linhas da matriz");
-        free(g);
-        return NULL;
+    if (mode == GRAPH_SPARSE) {
+        // Vetores de arestas crescem sob demanda em add_edge
+        return g;
     }
 
-    for (int i = 0; i < num_vertices; i++) {
-        g->matrix[i] = (int*)calloc(num_vertices, sizeof(int));
-        if (!g->matrix[i]) {
-            perror("Falha ao alocar memória para as colunas da matriz");
-            // Libera o que já foi alocado
-            for (int j = 0; j < i; j++) {
-                free(g->matrix[j]);
-            }
-            free(g->matrix);
-            free(g);
-            return NULL;
-        }
+    g->words_per_row = (num_vertices + 63) / 64;
+
+    // Matriz inteira em um único bloco: num_vertices * num_vertices bits
+    g->bits = (uint64_t*)arena_calloc(arena, (size_t)num_vertices * g->words_per_row, sizeof(uint64_t));
+    if (!g->bits) {
+        perror("Falha ao alocar memória para a matriz de adjacência");
+        arena_free(arena, g);
+        return NULL;
     }
     return g;
 }
 
 void free_graph(Graph* g) {
     if (!g) return;
-    for (int i = 0; i < g->num_vertices; i++) {
-        free(g->matrix[i]);
+    arena_free(g->arena, g->bits);
+    arena_free(g->arena, g->edge_from);
+    arena_free(g->arena, g->edge_to);
+    arena_free(g->arena, g->row_start);
+    arena_free(g->arena, g->adj);
+    arena_free(g->arena, g);
+}
+
+// Garante espaço para count arestas no modo esparso. 0 em erro.
+static int reserve_edges(Graph* g, int count) {
+    if (count <= g->edge_capacity) return 1;
+    int new_capacity = (g->edge_capacity == 0) ? 16 : g->edge_capacity * 2;
+    while (new_capacity < count) new_capacity *= 2;
+    size_t old_size = g->edge_capacity * sizeof(int);
+    int* new_from = (int*)arena_realloc(g->arena, g->edge_from, old_size, new_capacity * sizeof(int));
+    if (!new_from) {
+        perror("Falha ao realocar lista de arestas");
+        return 0;
+    }
+    g->edge_from = new_from;
+    int* new_to = (int*)arena_realloc(g->arena, g->edge_to, old_size, new_capacity * sizeof(int));
+    if (!new_to) {
+        perror("Falha ao realocar lista de arestas");
+        return 0;
+    }
+    g->edge_to = new_to;
+    g->edge_capacity = new_capacity;
+    return 1;
+}
+
+int add_edge(Graph* g, int from, int to) {
+    if (!g || from >= g->num_vertices || to >= g->num_vertices) return 1;
+
+    if (g->mode == GRAPH_DENSE) {
+        g->bits[(size_t)from * g->words_per_row + (to >> 6)] |= (uint64_t)1 << (to & 63);
+        return 1;
+    }
+
+    // Descarta a repetição imediata da mesma aresta, comum no índice de conflitos
+    if (g->edge_count > 0 && g->edge_from[g->edge_count - 1] == from &&
+        g->edge_to[g->edge_count - 1] == to) {
+        return 1;
     }
-    free(g->matrix);
-    free(g);
+    if (!reserve_edges(g, g->edge_count + 1)) return 0;
+    g->edge_from[g->edge_count] = from;
+    g->edge_to[g->edge_count] = to;
+    g->edge_count++;
+    g->csr_valid = 0;
+    return 1;
 }
 
-void add_edge(Graph* g, int from, int to) {
-    if (g && from < g->num_vertices && to < g->num_vertices) {
-        g->matrix[from][to] = 1;
+int add_edges(Graph* g, const int* from, const int* to, int count) {
+    if (!g) return 1;
+    if (g->mode == GRAPH_DENSE) {
+        for (int e = 0; e < count; e++) add_edge(g, from[e], to[e]); // Denso não aloca
+        return 1;
+    }
+    if (!reserve_edges(g, g->edge_count + count)) return 0;
+    for (int e = 0; e < count; e++) {
+        if (from[e] >= g->num_vertices || to[e] >= g->num_vertices) continue;
+        if (g->edge_count > 0 && g->edge_from[g->edge_count - 1] == from[e] &&
+            g->edge_to[g->edge_count - 1] == to[e]) {
+            continue;
+        }
+        g->edge_from[g->edge_count] = from[e];
+        g->edge_to[g->edge_count] = to[e];
+        g->edge_count++;
     }
+    g->csr_valid = 0;
+    return 1;
+}
+
+int graph_merge(Graph* dst, const Graph* src) {
+    if (!dst || !src) return 1;
+    if (dst->mode == GRAPH_DENSE && src->mode == GRAPH_DENSE) {
+        bitset_or(dst->bits, src->bits, src->num_vertices * src->words_per_row);
+        return 1;
+    }
+    if (src->mode == GRAPH_SPARSE) return add_edges(dst, src->edge_from, src->edge_to, src->edge_count);
+
+    // Denso para esparso: percorre as linhas de bits
+    for (int u = 0; u < src->num_vertices; u++) {
+        const uint64_t* row = src->bits + (size_t)u * src->words_per_row;
+        for (int k = 0; k < src->words_per_row; k++) {
+            for (uint64_t bits = row[k]; bits; bits &= bits - 1) {
+                int v = (k << 6) + __builtin_ctzll(bits);
+                if (!add_edges(dst, &u, &v, 1)) return 0;
+            }
+        }
+    }
+    return 1;
 }
 
 /**
- * @brief Função recursiva auxiliar para a detecção de ciclo (DFS).
- * @param g O grafo.
- * @param u O vertice atual sendo visitado.
- * @param color Array de cores que rastreia o estado de cada vertice.
- * @return 1 se um ciclo for detectado, 0 caso contrário.
+ * @brief Compacta a lista de arestas do modo esparso em CSR (counting sort por origem).
+ * @param g O grafo esparso.
+ * @return 1 em caso de sucesso, 0 em caso de falha de alocação.
  */
-int has_cycle_util(Graph* g, int u, Color* color) {
-    color[u] = GRAY; // Marca o vertice como visitando
+static int build_csr(Graph* g) {
+    if (g->csr_valid) return 1;
 
-    for (int v = 0; v < g->num_vertices; v++) {
-        if (g->matrix[u][v] == 1) { // Se existe uma aresta de u para v
-            if (color[v] == GRAY) {
-                // vertice v está na pilha de recursão entao tem ciclo
-                return 1;
+    arena_free(g->arena, g->row_start);
+    arena_free(g->arena, g->adj);
+    g->row_start = (int*)arena_calloc(g->arena, g->num_vertices + 1, sizeof(int));
+    g->adj = (int*)arena_alloc(g->arena, (g->edge_count > 0 ? g->edge_count : 1) * sizeof(int));
+    if (!g->row_start || !g->adj) {
+        perror("Falha ao alocar memória para o CSR");
+        return 0;
+    }
+
+    for (int e = 0; e < g->edge_count; e++) {
+        g->row_start[g->edge_from[e] + 1]++;
+    }
+    for (int u = 0; u < g->num_vertices; u++) {
+        g->row_start[u + 1] += g->row_start[u];
+    }
+    // Usa row_start[u] como cursor de inserção e depois o restaura
+    for (int e = 0; e < g->edge_count; e++) {
+        g->adj[g->row_start[g->edge_from[e]]++] = g->edge_to[e];
+    }
+    for (int u = g->num_vertices; u > 0; u--) {
+        g->row_start[u] = g->row_start[u - 1];
+    }
+    g->row_start[0] = 0;
+
+    g->csr_valid = 1;
+    return 1;
+}
+
+// --- Busca em profundidade iterativa ---
+
+int graph_work_reserve(GraphWork* w, int num_vertices) {
+    if (num_vertices <= w->capacity) return 1;
+
+    int words = (num_vertices + 63) / 64;
+    int old_words = (w->capacity + 63) / 64;
+    size_t old_ints = w->capacity * sizeof(int);
+    unsigned char* color = (unsigned char*)arena_realloc(w->arena, w->color, w->capacity, num_vertices);
+    int* stack = (int*)arena_realloc(w->arena, w->stack, old_ints, num_vertices * sizeof(int));
+    int* cursor = (int*)arena_realloc(w->arena, w->cursor, old_ints, num_vertices * sizeof(int));
+    uint64_t* white = (uint64_t*)arena_realloc(w->arena, w->white, old_words * sizeof(uint64_t),
+                                               words * sizeof(uint64_t));
+    uint64_t* gray = (uint64_t*)arena_realloc(w->arena, w->gray, old_words * sizeof(uint64_t),
+                                              words * sizeof(uint64_t));
+    // Cada realloc bem-sucedido já substituiu o bloco antigo
+    if (color) w->color = color;
+    if (stack) w->stack = stack;
+    if (cursor) w->cursor = cursor;
+    if (white) w->white = white;
+    if (gray) w->gray = gray;
+    if (!color || !stack || !cursor || !white || !gray) {
+        perror("Falha ao alocar memória para a busca em profundidade");
+        return 0;
+    }
+    w->capacity = num_vertices;
+    return 1;
+}
+
+GraphWork* create_graph_work(int capacity) {
+    return create_graph_work_in(NULL, capacity);
+}
+
+GraphWork* create_graph_work_in(Arena* arena, int capacity) {
+    GraphWork* w = (GraphWork*)arena_calloc(arena, 1, sizeof(GraphWork));
+    if (!w) {
+        perror("Falha ao alocar memória para a busca em profundidade");
+        return NULL;
+    }
+    w->arena = arena;
+    if (capacity > 0 && !graph_work_reserve(w, capacity)) {
+        free_graph_work(w);
+        return NULL;
+    }
+    return w;
+}
+
+void free_graph_work(GraphWork* w) {
+    if (!w) return;
+    arena_free(w->arena, w->color);
+    arena_free(w->arena, w->stack);
+    arena_free(w->arena, w->cursor);
+    arena_free(w->arena, w->white);
+    arena_free(w->arena, w->gray);
+    arena_free(w->arena, w);
+}
+
+/**
+ * @brief Próximo sucessor não preto de u a partir do cursor (modo denso).
+ *
+ * O cursor é a próxima coluna a examinar. Vértices pretos são pulados
+ * palavra a palavra com a máscara white | gray.
+ *
+ * @return O vértice encontrado, ou -1 se não houver mais sucessores.
+ */
+static int next_successor_dense(Graph* g, GraphWork* w, int u, int* cursor) {
+    const uint64_t* row = g->bits + (size_t)u * g->words_per_row;
+    int col = *cursor;
+    for (int k = col >> 6; k < g->words_per_row; k++) {
+        uint64_t pending = row[k] & (w->white[k] | w->gray[k]);
+        if (k == (col >> 6)) pending &= ~(uint64_t)0 << (col & 63);
+        if (pending) {
+            int v = (k << 6) + __builtin_ctzll(pending);
+            *cursor = v + 1;
+            return v;
+        }
+    }
+    *cursor = g->num_vertices;
+    return -1;
+}
+
+/**
+ * @brief Próximo sucessor não preto de u a partir do cursor (modo esparso).
+ *
+ * O cursor é a posição da próxima aresta de u em adj.
+ *
+ * @return O vértice encontrado, ou -1 se não houver mais sucessores.
+ */
+static int next_successor_sparse(Graph* g, GraphWork* w, int u, int* cursor) {
+    int end = g->row_start[u + 1];
+    while (*cursor < end) {
+        int v = g->adj[(*cursor)++];
+        if (w->color[v] != BLACK) return v;
+    }
+    return -1;
+}
+
+static void mark_gray(GraphWork* w, int u) {
+    w->color[u] = GRAY;
+    w->white[u >> 6] &= ~((uint64_t)1 << (u & 63));
+    w->gray[u >> 6] |= (uint64_t)1 << (u & 63);
+}
+
+static void mark_black(GraphWork* w, int u) {
+    w->color[u] = BLACK;
+    w->gray[u >> 6] &= ~((uint64_t)1 << (u & 63));
+}
+
+// Copia para out o trecho da pilha de v até o topo, que forma o ciclo.
+static int extract_cycle(GraphWork* w, int top, int v, int* out) {
+    int i = top;
+    while (w->stack[i] != v) i--;
+    int len = 0;
+    for (; i <= top; i++) out[len++] = w->stack[i];
+    return len;
+}
+
+int graph_order_or_cycle(Graph* g, GraphWork* w, int* out, int* out_len) {
+    *out_len = 0;
+    if (!g) return 0;
+    if (g->mode == GRAPH_SPARSE && !build_csr(g)) return -1;
+    if (!graph_work_reserve(w, g->num_vertices)) return -1;
+
+    int n = g->num_vertices;
+    int words = (n + 63) / 64;
+    for (int k = 0; k < words; k++) {
+        w->white[k] = ~(uint64_t)0;
+        w->gray[k] = 0;
+    }
+    for (int u = 0; u < n; u++) w->color[u] = WHITE;
+
+    // A ordem topológica é a pós-ordem invertida: preenchida do fim para o início
+    int order_pos = n;
+    long long visits = 0;
+
+    for (int root = 0; root < n; root++) {
+        if (w->color[root] != WHITE) continue;
+
+        int top = 0;
+        w->stack[0] = root;
+        w->cursor[0] = (g->mode == GRAPH_SPARSE) ? g->row_start[root] : 0;
+        mark_gray(w, root);
+        visits++;
+
+        while (top >= 0) {
+            int u = w->stack[top];
+
+            // Atalho vetorizado: algum sucessor de u já está no caminho atual
+            if (g->mode == GRAPH_DENSE && w->cursor[top] == 0 &&
+                bitset_intersects(g->bits + (size_t)u * g->words_per_row, w->gray, words)) {
+                const uint64_t* row = g->bits + (size_t)u * g->words_per_row;
+                for (int k = 0; k < words; k++) {
+                    if (row[k] & w->gray[k]) {
+                        int v = (k << 6) + __builtin_ctzll(row[k] & w->gray[k]);
+                        *out_len = extract_cycle(w, top, v, out);
+                        stats_add(STAT_DFS_VISITS, visits);
+                        return 1;
+                    }
+                }
             }
-            if (color[v] == WHITE && has_cycle_util(g, v, color)) {
-                // se v não foi visitado, visita e verifica por ciclos a partir dele.
+
+            int v = (g->mode == GRAPH_SPARSE) ? next_successor_sparse(g, w, u, &w->cursor[top])
+                                              : next_successor_dense(g, w, u, &w->cursor[top]);
+            if (v == -1) {
+                // Todos os sucessores visitados: u sai da pilha
+                mark_black(w, u);
+                out[--order_pos] = u;
+                top--;
+            } else if (w->color[v] == GRAY) {
+                // Aresta de retorno: v está na pilha, então tem ciclo
+                *out_len = extract_cycle(w, top, v, out);
+                stats_add(STAT_DFS_VISITS, visits);
                 return 1;
+            } else {
+                top++;
+                w->stack[top] = v;
+                w->cursor[top] = (g->mode == GRAPH_SPARSE) ? g->row_start[v] : 0;
+                mark_gray(w, v);
+                visits++;
             }
         }
     }
 
-    color[u] = BLACK; // Marca o vertice como totalmente visitado.
+    *out_len = n;
+    stats_add(STAT_DFS_VISITS, visits);
     return 0;
 }
 
 int has_cycle(Graph* g) {
     if (!g) return 0;
 
-    // Array para armazenar as cores de cada vertice.
-    // WHITE: não visitado, GRAY: visitando, BLACK: já visitado.
-    Color* color = (Color*)calloc(g->num_vertices, sizeof(Color));
-    if (!color) {
-        perror("Falha ao alocar memória para o vetor de cores");
+    GraphWork* w = create_graph_work_in(g->arena, g->num_vertices);
+    int* out = (int*)arena_alloc(g->arena, g->num_vertices * sizeof(int));
+    if (!w || !out) {
+        free_graph_work(w);
+        arena_free(g->arena, out);
         return 1; // Assume o pior caso para segurança
     }
 
-    // Chama a função de busca para cada vertice não visitado
-    for (int i = 0; i < g->num_vertices; i++) {
-        if (color[i] == WHITE) {
-            if (has_cycle_util(g, i, color)) {
-                free(color);
-                return 1;
-            }
-        }
-    }
+    int out_len;
+    int result = graph_order_or_cycle(g, w, out, &out_len);
 
-    free(color);
-    return 0;
+    free_graph_work(w);
+    arena_free(g->arena, out);
+    return result != 0; // Erros (-1) também contam como ciclo
 }
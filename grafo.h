@@ -9,26 +9,104 @@
 #ifndef GRAFO_H
 #define GRAFO_H
 
+#include <stdint.h>
+#include "arena.h"
+
+/**
+ * @brief Número de vértices a partir do qual create_graph usa a representação
+ * esparsa. Grafos de precedência reais têm poucas arestas por transação, e a
+ * matriz custa O(V²) em memória e na DFS.
+ */
+#ifndef GRAPH_SPARSE_THRESHOLD
+#define GRAPH_SPARSE_THRESHOLD 2048
+#endif
+
+/**
+ * @enum GraphMode
+ * @brief Representação interna das arestas do grafo.
+ */
+typedef enum {
+    GRAPH_AUTO,   // Escolhe pelo número de vértices (GRAPH_SPARSE_THRESHOLD).
+    GRAPH_DENSE,  // Matriz de adjacência em bits.
+    GRAPH_SPARSE  // Lista de arestas compactada em CSR antes da travessia.
+} GraphMode;
+
 /**
  * @struct Graph
- * @brief Representa um grafo direcionado usando uma matriz de adjacência.
+ * @brief Representa um grafo direcionado, como matriz de bits ou lista de arestas.
+ *
+ * No modo denso a matriz é um único bloco contíguo de palavras de 64 bits: a
+ * linha do vértice u ocupa words_per_row palavras a partir de
+ * bits[u * words_per_row], e o bit v dessa linha indica a aresta u -> v.
+ *
+ * No modo esparso as arestas são acumuladas em (edge_from, edge_to) e
+ * compactadas em CSR (row_start, adj) na primeira travessia: os sucessores de
+ * u são adj[row_start[u] .. row_start[u + 1] - 1].
+ *
  * @var Graph::num_vertices O número de vértices no grafo.
- * @var Graph::matrix A matriz de adjacência (ponteiro para ponteiro de int).
+ * @var Graph::mode GRAPH_DENSE ou GRAPH_SPARSE.
+ * @var Graph::words_per_row Número de palavras de 64 bits por linha (denso).
+ * @var Graph::bits A matriz de adjacência em bits (denso).
+ * @var Graph::edge_from Origens das arestas inseridas (esparso).
+ * @var Graph::edge_to Destinos das arestas inseridas (esparso).
+ * @var Graph::edge_count Número de arestas inseridas (esparso).
+ * @var Graph::edge_capacity Capacidade dos vetores de arestas (esparso).
+ * @var Graph::row_start Deslocamento de cada vértice em adj, V + 1 entradas (esparso).
+ * @var Graph::adj Destinos agrupados por origem (esparso).
+ * @var Graph::csr_valid Indica se o CSR reflete todas as arestas inseridas.
+ * @var Graph::arena Arena de onde saem os vetores do grafo (NULL = heap).
  */
 typedef struct {
     int num_vertices;
-    int** matrix;
+    GraphMode mode;
+
+    int words_per_row;
+    uint64_t* bits;
+
+    int* edge_from;
+    int* edge_to;
+    int edge_count;
+    int edge_capacity;
+    int* row_start;
+    int* adj;
+    int csr_valid;
+    Arena* arena;
 } Graph;
 
 // --- Protótipos das Funções ---
 
 /**
  * @brief Aloca memória e inicializa um novo grafo.
+ *
+ * A representação é escolhida automaticamente: esparsa a partir de
+ * GRAPH_SPARSE_THRESHOLD vértices, densa abaixo disso.
+ *
  * @param num_vertices O número de vértices que o grafo terá.
  * @return Um ponteiro para o novo grafo criado, ou NULL em caso de falha.
  */
 Graph* create_graph(int num_vertices);
 
+/**
+ * @brief Aloca um novo grafo com a representação indicada.
+ * @param num_vertices O número de vértices que o grafo terá.
+ * @param mode GRAPH_DENSE, GRAPH_SPARSE ou GRAPH_AUTO.
+ * @return Um ponteiro para o novo grafo criado, ou NULL em caso de falha.
+ */
+Graph* create_graph_mode(int num_vertices, GraphMode mode);
+
+/**
+ * @brief Aloca um novo grafo dentro de uma arena.
+ *
+ * free_graph não devolve nada ao heap nesse caso: a memória volta com o
+ * arena_reset.
+ *
+ * @param arena A arena, ou NULL para usar o heap.
+ * @param num_vertices O número de vértices que o grafo terá.
+ * @param mode GRAPH_DENSE, GRAPH_SPARSE ou GRAPH_AUTO.
+ * @return Um ponteiro para o novo grafo criado, ou NULL em caso de falha.
+ */
+Graph* create_graph_in(Arena* arena, int num_vertices, GraphMode mode);
+
 /**
  * @brief Libera toda a memória alocada para o grafo.
  * @param g Ponteiro para o grafo a ser liberado.
@@ -37,21 +115,151 @@ void free_graph(Graph* g);
 
 /**
  * @brief Adiciona uma aresta direcionada no grafo.
+ *
+ * Uma aresta perdida pode esconder um ciclo: quem chama deve tratar a falha
+ * como erro, e não seguir com o grafo incompleto.
+ *
  * @param g O grafo onde a aresta será adicionada.
  * @param from O vértice de origem (índice).
  * @param to O vértice de destino (índice).
+ * @return 1 em caso de sucesso, 0 em falha de alocação (modo esparso).
+ */
+int add_edge(Graph* g, int from, int to);
+
+/**
+ * @brief Adiciona várias arestas de uma vez, na ordem dada.
+ *
+ * Equivale a chamar add_edge para cada par (inclusive no descarte da
+ * repetição imediata no modo esparso), mas reserva o espaço de uma vez.
+ *
+ * @param g O grafo onde as arestas serão adicionadas.
+ * @param from As origens.
+ * @param to Os destinos.
+ * @param count Número de arestas.
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int add_edges(Graph* g, const int* from, const int* to, int count);
+
+/**
+ * @brief Junta em dst as arestas de src.
+ *
+ * Os dois grafos devem ter o mesmo número de vértices. Entre grafos densos é
+ * a união das linhas de bits; nos demais casos, as arestas de src são
+ * adicionadas em dst na ordem em que foram inseridas.
+ *
+ * @param dst O grafo que recebe as arestas.
+ * @param src O grafo de onde vêm as arestas (não é alterado).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int graph_merge(Graph* dst, const Graph* src);
+
+/**
+ * @struct GraphWork
+ * @brief Área de trabalho reutilizável da busca em profundidade iterativa.
+ *
+ * Pode ser alocada uma vez e usada em vários grafos; cresce sob demanda até
+ * o maior número de vértices visto.
+ *
+ * @var GraphWork::capacity Número de vértices suportado sem realocar.
+ * @var GraphWork::color Cor de cada vértice (branco, cinza ou preto).
+ * @var GraphWork::stack Caminho atual da DFS (pilha explícita).
+ * @var GraphWork::cursor Posição do próximo sucessor a examinar em cada nível da pilha.
+ * @var GraphWork::white Vetor de bits dos vértices ainda não visitados.
+ * @var GraphWork::gray Vetor de bits dos vértices no caminho atual.
+ * @var GraphWork::arena Arena de onde saem os vetores (NULL = heap).
+ */
+typedef struct {
+    int capacity;
+    unsigned char* color;
+    int* stack;
+    int* cursor;
+    uint64_t* white;
+    uint64_t* gray;
+    Arena* arena;
+} GraphWork;
+
+/**
+ * @brief Aloca uma área de trabalho para a DFS.
+ * @param capacity Número de vértices a reservar de início (pode ser 0).
+ * @return A área alocada, ou NULL em caso de falha.
+ */
+GraphWork* create_graph_work(int capacity);
+
+/**
+ * @brief Aloca uma área de trabalho para a DFS dentro de uma arena.
+ * @param arena A arena, ou NULL para usar o heap.
+ * @param capacity Número de vértices a reservar de início (pode ser 0).
+ * @return A área alocada, ou NULL em caso de falha.
+ */
+GraphWork* create_graph_work_in(Arena* arena, int capacity);
+
+/**
+ * @brief Garante que a área de trabalho comporte num_vertices vértices.
+ * @param w A área de trabalho.
+ * @param num_vertices O número de vértices necessário.
+ * @return 1 em caso de sucesso, 0 em caso de falha de alocação.
+ */
+int graph_work_reserve(GraphWork* w, int num_vertices);
+
+/**
+ * @brief Libera uma área de trabalho da DFS.
+ * @param w A área a ser liberada.
  */
-void add_edge(Graph* g, int from, int to);
+void free_graph_work(GraphWork* w);
+
+/**
+ * @brief Calcula uma ordem topológica do grafo ou encontra um ciclo.
+ *
+ * DFS iterativa (sem recursão) sobre a área de trabalho w. Se o grafo for
+ * acíclico, out recebe os num_vertices vértices em ordem topológica (o
+ * escalonamento serial equivalente). Caso contrário, out recebe os vértices
+ * de um ciclo, na ordem das arestas: out[0] -> out[1] -> ... -> out[0].
+ *
+ * @param g O grafo a ser analisado.
+ * @param w Área de trabalho reutilizável.
+ * @param out Vetor de saída com espaço para num_vertices elementos.
+ * @param out_len Recebe o número de elementos escritos em out.
+ * @return 0 se acíclico, 1 se há ciclo, -1 em caso de falha de alocação.
+ */
+int graph_order_or_cycle(Graph* g, GraphWork* w, int* out, int* out_len);
 
 /**
  * @brief Verifica se o grafo contém algum ciclo.
  *
- * Utiliza um algoritmo de busca em profundidade (DFS) para detectar
+ * Utiliza um algoritmo de busca em profundidade (DFS) iterativa para detectar
  * a presença de arestas de retorno (back edges), que indicam um ciclo.
+ * No modo denso os sucessores são obtidos palavra a palavra com ctz; no
+ * esparso a busca percorre o CSR em O(V + E).
  *
  * @param g O grafo a ser verificado.
  * @return 1 se um ciclo for encontrado, 0 caso contrário.
  */
 int has_cycle(Graph* g);
 
-#endif // GRAFO_H
\ No newline at end of file
+// --- Operações sobre linhas de bits ---
+
+/**
+ * @brief Verifica se dois vetores de bits têm algum bit em comum (a & b != 0).
+ *
+ * Usa AVX2 ou SSE2 quando a CPU suporta (escolhido em tempo de execução) e
+ * um laço portável caso contrário.
+ *
+ * @param a Primeiro vetor.
+ * @param b Segundo vetor.
+ * @param words Número de palavras de 64 bits.
+ * @return 1 se houver interseção, 0 caso contrário.
+ */
+int bitset_intersects(const uint64_t* a, const uint64_t* b, int words);
+
+/**
+ * @brief Faz a união dst |= src entre dois vetores de bits.
+ *
+ * Mesma seleção de implementação de bitset_intersects.
+ *
+ * @param dst Vetor de destino.
+ * @param src Vetor de origem.
+ * @param words Número de palavras de 64 bits.
+ */
+void bitset_or(uint64_t* dst, const uint64_t* src, int words);
+
+#endif // GRAFO_H
@@ -0,0 +1,207 @@
+/**
+ * @file lote.c
+ * @brief Implementação do pipeline de processamento em lote.
+ *
+ * Fila circular limitada de escalonamentos (leitora -> threads de trabalho)
+ * e uma janela circular de resultados indexada por schedule_id, usada para
+ * reordenar a saída: a thread que completa o próximo identificador esperado
+ * imprime todos os resultados consecutivos já prontos. Cada posição da
+ * janela tem uma arena, então em regime o lote não faz chamadas ao heap.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "lote.h"
+
+// Um escalonamento na fila de entrada.
+typedef struct {
+    Schedule* schedule;
+    int schedule_id;
+} BatchJob;
+
+// Um resultado aguardando impressão e a arena da sua posição.
+typedef struct {
+    char* text;
+    size_t length;
+    int ready;
+    Arena* arena;      // Arena da posição, reaproveitada a cada volta da janela
+    Arena* text_arena; // Arena de onde saiu text
+} BatchResult;
+
+struct BatchPipeline {
+    ScheduleHandler handler;
+    FILE* out;
+
+    pthread_t* threads;
+    int worker_count;
+
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;  // Há trabalho na fila (ou o lote acabou)
+    pthread_cond_t not_full;   // Há espaço na fila e na janela de resultados
+
+    BatchJob* queue;
+    int queue_capacity;
+    int queue_head;
+    int queue_count;
+    int closed;
+
+    // Janela de resultados: o id k ocupa a posição k % window
+    BatchResult* results;
+    int window;
+    int next_to_print;
+};
+
+static void* batch_worker(void* arg) {
+    BatchPipeline* b = (BatchPipeline*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&b->lock);
+        while (b->queue_count == 0 && !b->closed) {
+            pthread_cond_wait(&b->not_empty, &b->lock);
+        }
+        if (b->queue_count == 0) {
+            pthread_mutex_unlock(&b->lock);
+            break;
+        }
+        BatchJob job = b->queue[b->queue_head];
+        b->queue_head = (b->queue_head + 1) % b->queue_capacity;
+        b->queue_count--;
+        pthread_cond_broadcast(&b->not_full);
+        pthread_mutex_unlock(&b->lock);
+
+        // Analisa fora da trava; o resultado fica na arena do escalonamento
+        size_t length = 0;
+        char* text = b->handler(job.schedule, job.schedule_id, &length);
+        Arena* text_arena = job.schedule->arena;
+        free_schedule(job.schedule);
+
+        pthread_mutex_lock(&b->lock);
+        BatchResult* r = &b->results[job.schedule_id % b->window];
+        r->text = text;
+        r->length = text ? length : 0;
+        r->text_arena = text_arena;
+        r->ready = 1;
+
+        // Estágio de reordenação: imprime os resultados consecutivos prontos
+        int printed = 0;
+        for (;;) {
+            BatchResult* next = &b->results[b->next_to_print % b->window];
+            if (!next->ready) break;
+            if (next->length > 0) fwrite(next->text, 1, next->length, b->out);
+            arena_free(next->text_arena, next->text);
+            next->text = NULL;
+            next->ready = 0;
+            b->next_to_print++;
+            printed = 1;
+        }
+        if (printed) pthread_cond_broadcast(&b->not_full);
+        pthread_mutex_unlock(&b->lock);
+    }
+    return NULL;
+}
+
+BatchPipeline* batch_start(int workers, int queue_capacity, ScheduleHandler handler, FILE* out) {
+    if (workers < 1) workers = 1;
+    if (queue_capacity < 1) queue_capacity = 1;
+
+    BatchPipeline* b = (BatchPipeline*)calloc(1, sizeof(BatchPipeline));
+    if (!b) {
+        perror("Falha ao alocar pipeline de lote");
+        return NULL;
+    }
+    b->handler = handler;
+    b->out = out;
+    b->queue_capacity = queue_capacity;
+    // Cabem na janela todos os ids na fila, em análise ou esperando impressão
+    b->window = queue_capacity + workers + 1;
+    b->next_to_print = 1;
+    b->queue = (BatchJob*)malloc(queue_capacity * sizeof(BatchJob));
+    b->results = (BatchResult*)calloc(b->window, sizeof(BatchResult));
+    b->threads = (pthread_t*)malloc(workers * sizeof(pthread_t));
+    int ok = b->queue && b->results && b->threads;
+    for (int i = 0; ok && i < b->window; i++) {
+        b->results[i].arena = arena_create(0);
+        ok = b->results[i].arena != NULL;
+    }
+    if (!ok) {
+        perror("Falha ao alocar pipeline de lote");
+        for (int i = 0; b->results && i < b->window; i++) {
+            arena_destroy(b->results[i].arena);
+        }
+        free(b->queue);
+        free(b->results);
+        free(b->threads);
+        free(b);
+        return NULL;
+    }
+
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->not_empty, NULL);
+    pthread_cond_init(&b->not_full, NULL);
+
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&b->threads[i], NULL, batch_worker, b) != 0) {
+            perror("Falha ao criar thread de trabalho");
+            break;
+        }
+        b->worker_count++;
+    }
+    if (b->worker_count == 0) {
+        batch_finish(b);
+        return NULL;
+    }
+    return b;
+}
+
+Arena* batch_arena(BatchPipeline* b, int schedule_id) {
+    pthread_mutex_lock(&b->lock);
+    // A posição fica livre quando o ocupante anterior (schedule_id - window) é impresso
+    while (schedule_id - b->next_to_print >= b->window) {
+        pthread_cond_wait(&b->not_full, &b->lock);
+    }
+    Arena* arena = b->results[schedule_id % b->window].arena;
+    pthread_mutex_unlock(&b->lock);
+
+    arena_reset(arena);
+    return arena;
+}
+
+void batch_submit(BatchPipeline* b, Schedule* s, int schedule_id) {
+    pthread_mutex_lock(&b->lock);
+    // Espera espaço na fila e na janela de reordenação
+    while (b->queue_count == b->queue_capacity ||
+           schedule_id - b->next_to_print >= b->window) {
+        pthread_cond_wait(&b->not_full, &b->lock);
+    }
+    int tail = (b->queue_head + b->queue_count) % b->queue_capacity;
+    b->queue[tail] = (BatchJob){s, schedule_id};
+    b->queue_count++;
+    pthread_cond_signal(&b->not_empty);
+    pthread_mutex_unlock(&b->lock);
+}
+
+void batch_finish(BatchPipeline* b) {
+    if (!b) return;
+
+    pthread_mutex_lock(&b->lock);
+    b->closed = 1;
+    pthread_cond_broadcast(&b->not_empty);
+    pthread_mutex_unlock(&b->lock);
+
+    for (int i = 0; i < b->worker_count; i++) {
+        pthread_join(b->threads[i], NULL);
+    }
+    fflush(b->out);
+
+    for (int i = 0; i < b->window; i++) {
+        arena_free(b->results[i].text_arena, b->results[i].text);
+        arena_destroy(b->results[i].arena);
+    }
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->not_empty);
+    pthread_cond_destroy(&b->not_full);
+    free(b->queue);
+    free(b->results);
+    free(b->threads);
+    free(b);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file lote.h
+ * @brief Processamento em lote de escalonamentos independentes em paralelo.
+ *
+ * A thread leitora corta os escalonamentos e os entrega a um conjunto de
+ * threads de trabalho por uma fila limitada. Os resultados são impressos na
+ * ordem dos identificadores, de modo que a saída é idêntica à do modo serial.
+ *
+ * Cada posição da janela de reordenação tem sua própria arena: o
+ * escalonamento, os dados da análise e a linha de resultado saem dela, e ela
+ * é reaproveitada quando a posição volta a ficar livre.
+ */
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <stdio.h>
+#include "algoritmos.h"
+
+/**
+ * @brief Função que analisa um escalonamento e devolve a linha de resultado.
+ *
+ * O texto deve ser alocado na arena do escalonamento (s->arena) e pode ser
+ * NULL quando não há nada a imprimir; length recebe o seu tamanho.
+ */
+typedef char* (*ScheduleHandler)(Schedule* s, int schedule_id, size_t* length);
+
+/**
+ * @struct BatchPipeline
+ * @brief Estado opaco do pipeline de processamento em lote.
+ */
+typedef struct BatchPipeline BatchPipeline;
+
+/**
+ * @brief Inicia as threads de trabalho do pipeline.
+ * @param workers Número de threads de trabalho.
+ * @param queue_capacity Capacidade da fila entre a leitora e as threads.
+ * @param handler Função de análise de cada escalonamento.
+ * @param out Destino dos resultados, escritos em ordem de schedule_id.
+ * @return O pipeline criado, ou NULL em caso de falha.
+ */
+BatchPipeline* batch_start(int workers, int queue_capacity, ScheduleHandler handler, FILE* out);
+
+/**
+ * @brief Obtém a arena onde o escalonamento schedule_id deve ser construído.
+ *
+ * Bloqueia até que a posição do identificador na janela de reordenação
+ * esteja livre e então zera a arena dessa posição.
+ *
+ * @param b O pipeline.
+ * @param schedule_id O identificador do próximo escalonamento a ser entregue.
+ * @return A arena da posição.
+ */
+Arena* batch_arena(BatchPipeline* b, int schedule_id);
+
+/**
+ * @brief Entrega um escalonamento ao pipeline.
+ *
+ * Bloqueia enquanto a fila estiver cheia ou enquanto houver resultados
+ * demais aguardando impressão. O pipeline passa a ser dono de s.
+ * Os identificadores devem ser consecutivos, começando em 1.
+ *
+ * @param b O pipeline.
+ * @param s O escalonamento completo.
+ * @param schedule_id O identificador numérico do escalonamento.
+ */
+void batch_submit(BatchPipeline* b, Schedule* s, int schedule_id);
+
+/**
+ * @brief Espera todos os escalonamentos entregues, imprime o restante e libera o pipeline.
+ * @param b O pipeline.
+ */
+void batch_finish(BatchPipeline* b);
+
+#endif // LOTE_H
@@ -2,12 +2,48 @@
  * @file main.c
  * @brief inicio do programa escalona.
  *
- * le as transacoes do stdin e executa os testes de seriabilidade
+ * le as transacoes de um arquivo (ou do stdin) e executa os testes de seriabilidade
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "algoritmos.h"
+#include "lote.h"
+#include "entrada.h"
+#include "binario.h"
+#include "fluxo.h"
+#include "estatisticas.h"
+#include "retomada.h"
+#include "cache.h"
+
+// Capacidade da fila entre a leitura e as threads do modo em lote, por thread.
+#define BATCH_QUEUE_PER_WORKER 4
+
+// Com --mem-stats, conta os escalonamentos cuja análise chamou o heap.
+static int mem_stats = 0;
+static atomic_long schedules_analyzed = 0;
+static atomic_long schedules_using_heap = 0;
+
+// Com --online, o teste por conflito também roda operação a operação.
+static int online_check = 0;
+
+// Com --checkpoint, pontos de parada do teste por visão (lidos e a gravar).
+static CheckpointStore* checkpoints = NULL;
+
+// Com --cache ou --cache-size, vereditos por forma canônica do escalonamento.
+static VerdictCache* verdict_cache = NULL;
+
+// Com --witness, uma linha JSON por escalonamento com as ordens seriais ou a
+// evidência de cada veredito. Os nomes dos atributos vêm da tabela da
+// entrada texto ou do arquivo binário.
+static int witness_output = 0;
+static const AttrTable* attr_names = NULL;
+static const BinaryFile* binary_names = NULL;
+
+// Com --classes, as colunas de recuperabilidade (RC/NR), de abortos em
+// cascata (ACA/NA) e de estrito (ST/NST), da passada do teste por conflito.
+static int classes_output = 0;
 
 /**
  * @brief Adiciona um ID de transação na lista de ativas, se ainda não estiver presente.
@@ -25,7 +61,7 @@ void add_active_trans(int** active_list, int* count, int* capacity, int trans_id
 
     if (*count >= *capacity) {
         *capacity = (*capacity == 0) ? 10 : *capacity * 2;
-        int* new_list = (int*)realloc(*active_list, *capacity * sizeof(int));
+        int* new_list = (int*)arena_realloc(NULL, *active_list, 0, *capacity * sizeof(int));
         if (!new_list) {
             perror("Falha ao realocar lista de transacoes ativas");
             exit(EXIT_FAILURE);
@@ -60,71 +96,782 @@ void remove_active_trans(int* active_list, int* count, int trans_id) {
 }
 
 /**
- * @brief Processa um escalonamento completo: executa os testes e imprime o resultado.
+ * @struct CommittedSet
+ * @brief IDs das transações que já fizeram commit no escalonamento atual.
+ *
+ * O teste incremental pode já ter descartado uma transação efetivada e não
+ * teria como reencontrar as arestas dela se o ID voltasse. Com --gc, uma
+ * operação depois do commit da própria transação é rejeitada; com --online,
+ * o teste incremental é desligado no resto do escalonamento, e o veredito
+ * normal não muda. Tabela hash com sondagem linear; esvaziar é trocar a geração.
+ */
+typedef struct {
+    int* keys;
+    unsigned* gen;     // Geração em que a posição foi ocupada
+    unsigned current;
+    size_t mask;
+    size_t count;
+} CommittedSet;
+
+static size_t committed_slot(const CommittedSet* c, int trans_id) {
+    size_t i = ((uint32_t)trans_id * 2654435761u) & c->mask;
+    while (c->gen[i] == c->current && c->keys[i] != trans_id) i = (i + 1) & c->mask;
+    return i;
+}
+
+static int committed_contains(const CommittedSet* c, int trans_id) {
+    return c->count > 0 && c->gen[committed_slot(c, trans_id)] == c->current;
+}
+
+// Acrescenta o ID (se ainda não estiver). 0 em falha de alocação.
+static int committed_add(CommittedSet* c, int trans_id) {
+    if ((c->count + 1) * 2 > c->mask + 1 || !c->gen) {
+        CommittedSet bigger = {NULL, NULL, 1, c->gen ? c->mask * 2 + 1 : 15, 0};
+        bigger.keys = (int*)malloc((bigger.mask + 1) * sizeof(int));
+        bigger.gen = (unsigned*)calloc(bigger.mask + 1, sizeof(unsigned));
+        if (!bigger.keys || !bigger.gen) {
+            perror("Falha ao alocar transações efetivadas");
+            free(bigger.keys);
+            free(bigger.gen);
+            return 0;
+        }
+        for (size_t i = 0; c->gen && i <= c->mask; i++) {
+            if (c->gen[i] != c->current) continue;
+            size_t j = committed_slot(&bigger, c->keys[i]);
+            bigger.keys[j] = c->keys[i];
+            bigger.gen[j] = bigger.current;
+            bigger.count++;
+        }
+        free(c->keys);
+        free(c->gen);
+        *c = bigger;
+    }
+    size_t i = committed_slot(c, trans_id);
+    if (c->gen[i] != c->current) {
+        c->keys[i] = trans_id;
+        c->gen[i] = c->current;
+        c->count++;
+    }
+    return 1;
+}
+
+// Esvazia o conjunto no fim do escalonamento.
+static void committed_clear(CommittedSet* c) {
+    c->count = 0;
+    if (++c->current == 0) {
+        // Estouro da geração: zera as marcas
+        if (c->gen) memset(c->gen, 0, (c->mask + 1) * sizeof(unsigned));
+        c->current = 1;
+    }
+}
+
+static void committed_free(CommittedSet* c) {
+    free(c->keys);
+    free(c->gen);
+}
+
+// Rejeita a operação se a transação já fez commit. 1 se a operação é aceita.
+static int check_after_commit(CommittedSet* c, const Operation* op, int schedule_id) {
+    if (committed_contains(c, op->trans_id)) {
+        fprintf(stderr, "escalona: escalonamento %d: operação da transação %d depois do seu commit (tempo %d)\n",
+                schedule_id, op->trans_id, op->time);
+        return 0;
+    }
+    return op->op != 'C' || committed_add(c, op->trans_id);
+}
+
+/**
+ * @brief Executa os testes de seriabilidade de um escalonamento.
+ *
+ * Com --checkpoint, retoma a busca do teste por visão do ponto guardado e
+ * guarda o novo ponto se o orçamento acabar de novo.
+ *
+ * @param a A análise do escalonamento (os dois testes a compartilham).
+ * @param schedule_id O identificador numérico do escalonamento.
+ * @param conflict Recebe o veredito por conflito.
+ * @param view Recebe o veredito por visão (ou VIEW_UNKNOWN).
+ * @param witness Recebe a evidência do teste por visão, ou NULL.
+ */
+static void analyze_schedule(ScheduleAnalysis* a, int schedule_id, int* conflict, int* view, ViewWitness* witness) {
+    // Com orçamento, o teste por visão pode parar sem resposta (NV?)
+    ViewCheckpoint resume = {VIEW_RESUME_NONE, 0, NULL};
+    ViewCheckpoint stopped;
+    uint64_t fingerprint = 0;
+    if (checkpoints) {
+        fingerprint = schedule_fingerprint(a->s);
+        checkpoint_find(checkpoints, schedule_id, fingerprint, &resume);
+    }
+
+    *conflict = analysis_conflict(a);
+    *view = analysis_view(a, &resume, checkpoints ? &stopped : NULL, witness);
+    if (checkpoints && *view == VIEW_UNKNOWN) {
+        checkpoint_record(checkpoints, schedule_id, fingerprint, &stopped);
+    }
+}
+
+/**
+ * @brief Nome de um atributo do escalonamento, pelo índice denso.
+ * @param s O escalonamento.
+ * @param attr_idx O índice denso (Operation::attr_idx).
+ * @return O nome, ou "-" se não há tabela de nomes.
+ */
+static const char* schedule_attr_name(const Schedule* s, int attr_idx) {
+    // attr_idx segue a ordem de primeira aparição: a busca para cedo
+    int id = NO_ATTR;
+    for (int i = 0; i < s->op_count && id == NO_ATTR; i++) {
+        if (s->ops[i].attr_idx == attr_idx) id = s->ops[i].attr;
+    }
+    if (binary_names) return binary_attr_name(binary_names, id);
+    return attr_names ? attr_name(attr_names, id) : "-";
+}
+
+/**
+ * @brief Escreve uma string JSON (entre aspas, com escapes).
+ * @return O número de caracteres escritos (no máximo 2 + 6 * strlen(str)).
+ */
+static size_t json_string(char* out, const char* str) {
+    size_t n = 0;
+    out[n++] = '"';
+    for (const unsigned char* c = (const unsigned char*)str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out[n++] = '\\';
+            out[n++] = (char)*c;
+        } else if (*c < 0x20) {
+            n += sprintf(out + n, "\\u%04x", *c);
+        } else {
+            out[n++] = (char)*c;
+        }
+    }
+    out[n++] = '"';
+    return n;
+}
+
+/**
+ * @brief Escreve uma lista JSON de IDs de transação a partir de índices densos.
+ * @return O número de caracteres escritos (no máximo 2 + 12 * len).
+ */
+static size_t json_trans_list(char* out, const Schedule* s, const int* idx, int len) {
+    size_t n = 0;
+    out[n++] = '[';
+    for (int i = 0; i < len; i++) {
+        n += sprintf(out + n, "%s%d", i ? "," : "", s->trans_ids[idx[i]]);
+    }
+    out[n++] = ']';
+    return n;
+}
+
+/**
+ * @brief Formata o resultado de --witness: uma linha JSON por escalonamento.
+ *
+ * Além das colunas da saída normal, traz a ordem serial equivalente (SS e
+ * SV), o ciclo de conflito (NS) e a restrição de visão violada (NV).
+ *
+ * @param a A análise, com a ordem ou o ciclo do teste por conflito.
+ * @param classes As classes de recuperação (--classes), ou NULL.
+ * @return A linha, alocada na arena do escalonamento, ou NULL.
+ */
+static char* format_witness(const ScheduleAnalysis* a, int schedule_id, int view, const ViewWitness* w,
+                            const ScheduleClasses* classes, size_t* length) {
+    Schedule* s = a->s;
+    int has_attr = view == 0 && (w->kind == VIEW_WITNESS_READ || w->kind == VIEW_WITNESS_FINAL_WRITE);
+    const char* name = has_attr ? schedule_attr_name(s, w->attr) : "";
+
+    // Três listas de transações, o nome escapado e as chaves fixas
+    size_t capacity = 256 + 3 * (2 + (size_t)s->trans_count * 12) + 6 * strlen(name);
+    char* text = (char*)arena_alloc(s->arena, capacity);
+    if (!text) {
+        perror("Falha ao alocar linha de resultado");
+        return NULL;
+    }
+    int* all = (int*)arena_alloc(s->arena, (s->trans_count + 1) * sizeof(int));
+    if (!all) {
+        perror("Falha ao alocar linha de resultado");
+        arena_free(s->arena, text);
+        return NULL;
+    }
+    for (int i = 0; i < s->trans_count; i++) all[i] = i;
+
+    size_t n = sprintf(text, "{\"escalonamento\":%d,\"transacoes\":", schedule_id);
+    n += json_trans_list(text + n, s, all, s->trans_count);
+    n += sprintf(text + n, ",\"conflito\":\"%s\",\"%s\":", a->conflict ? "SS" : "NS",
+                 a->conflict ? "ordem_conflito" : "ciclo");
+    n += json_trans_list(text + n, s, a->evidence, a->evidence_len);
+    n += sprintf(text + n, ",\"visao\":\"%s\"", view == VIEW_UNKNOWN ? "NV?" : view ? "SV" : "NV");
+    if (classes) {
+        n += sprintf(text + n, ",\"classes\":[\"%s\",\"%s\",\"%s\"]", classes->recoverable ? "RC" : "NR",
+                     classes->cascadeless ? "ACA" : "NA", classes->strict ? "ST" : "NST");
+    }
+
+    if (view == 1 && w->kind == VIEW_WITNESS_ORDER) {
+        n += sprintf(text + n, ",\"ordem_visao\":");
+        n += json_trans_list(text + n, s, w->order, s->trans_count);
+    } else if (view == 0 && w->kind != VIEW_WITNESS_NONE) {
+        n += sprintf(text + n, ",\"violacao\":{\"tipo\":");
+        switch (w->kind) {
+        case VIEW_WITNESS_READ:
+            n += sprintf(text + n, "\"leitura\",\"transacao\":%d,\"atributo\":", s->trans_ids[w->trans]);
+            n += json_string(text + n, name);
+            if (w->other < 0) n += sprintf(text + n, ",\"escritor\":null");
+            else n += sprintf(text + n, ",\"escritor\":%d", s->trans_ids[w->other]);
+            break;
+        case VIEW_WITNESS_FINAL_WRITE:
+            n += sprintf(text + n, "\"escrita_final\",\"transacao\":%d,\"atributo\":", s->trans_ids[w->trans]);
+            n += json_string(text + n, name);
+            n += sprintf(text + n, ",\"escritor_final\":%d", s->trans_ids[w->other]);
+            break;
+        case VIEW_WITNESS_CONFLICT:
+            n += sprintf(text + n, "\"ciclo_de_conflito\"");
+            break;
+        default:
+            n += sprintf(text + n, "\"busca\"");
+            break;
+        }
+        text[n++] = '}';
+    }
+    n += sprintf(text + n, "}\n");
+    arena_free(s->arena, all);
+    *length = n;
+    return text;
+}
+
+/**
+ * @brief Processa um escalonamento completo: executa os testes e formata o resultado.
  * @param s O escalonamento a ser processado.
  * @param schedule_id O identificador numérico do escalonamento.
+ * @param length Recebe o tamanho da linha de resultado.
+ * @return A linha de resultado, alocada na arena do escalonamento, ou NULL.
  */
-void process_schedule(Schedule* s, int schedule_id) {
-    if (s == NULL || s->op_count == 0) return;
+char* process_schedule(Schedule* s, int schedule_id, size_t* length) {
+    *length = 0;
+    if (s == NULL || s->op_count == 0) return NULL;
+    long heap_before = arena_thread_heap_calls();
+    long long start = stats_clock();
 
-    find_unique_transactions(s);
+    // Índices densos, grafo e tabelas: calculados uma vez para os dois testes
+    ScheduleAnalysis analysis;
+    analysis_init(&analysis, s);
+    analysis.want_classes = classes_output;
+
+    // Escalonamentos com a mesma forma já vistos não passam pelos algoritmos
+    int conflict_serializable, view_serializable;
+    ViewWitness witness;
+    ScheduleSignature sig = {NULL, 0, 0};
+    if (!verdict_cache || !schedule_signature(s, &sig) ||
+        !cache_lookup(verdict_cache, &sig, &conflict_serializable, &view_serializable)) {
+        analyze_schedule(&analysis, schedule_id, &conflict_serializable, &view_serializable,
+                         witness_output ? &witness : NULL);
+        // NV? depende do orçamento, não da forma: não vai para o cache
+        if (sig.data && view_serializable != VIEW_UNKNOWN) {
+            cache_insert(verdict_cache, &sig, conflict_serializable, view_serializable);
+        }
+    }
+    arena_free(s->arena, sig.data);
+    if (stats_enabled()) stats_record_schedule(schedule_id, stats_clock() - start);
 
-    int conflict_serializable = is_conflict_serializable(s);
-    int view_serializable = is_view_serializable(s);
+    const ScheduleClasses* classes = classes_output ? analysis_classes(&analysis) : NULL;
 
-    printf("%d ", schedule_id);
-    for (int i = 0; i < s->trans_count; i++) {
-        printf("%d%s", s->trans_ids[i], (i == s->trans_count - 1) ? "" : ",");
+    char* text;
+    if (witness_output) {
+        text = format_witness(&analysis, schedule_id, view_serializable, &witness, classes, length);
+    } else {
+        // Cada ID ocupa no máximo 11 caracteres mais a vírgula
+        size_t capacity = 48 + (size_t)s->trans_count * 12;
+        text = (char*)arena_alloc(s->arena, capacity);
+        if (!text) perror("Falha ao alocar linha de resultado");
+        size_t n = 0;
+        if (text) {
+            n = snprintf(text, capacity, "%d ", schedule_id);
+            for (int i = 0; i < s->trans_count; i++) {
+                n += snprintf(text + n, capacity - n, "%d%s", s->trans_ids[i], (i == s->trans_count - 1) ? "" : ",");
+            }
+            n += snprintf(text + n, capacity - n, " %s", conflict_serializable ? "SS" : "NS");
+            n += snprintf(text + n, capacity - n, " %s", view_serializable == VIEW_UNKNOWN ? "NV?" : view_serializable ? "SV" : "NV");
+            if (classes) {
+                n += snprintf(text + n, capacity - n, " %s %s %s", classes->recoverable ? "RC" : "NR",
+                              classes->cascadeless ? "ACA" : "NA", classes->strict ? "ST" : "NST");
+            }
+            n += snprintf(text + n, capacity - n, "\n");
+        }
+        *length = n;
+    }
+    analysis_free(&analysis);
+
+    if (mem_stats) {
+        atomic_fetch_add(&schedules_analyzed, 1);
+        if (arena_thread_heap_calls() != heap_before) atomic_fetch_add(&schedules_using_heap, 1);
     }
-    printf(" %s", conflict_serializable ? "SS" : "NS");
-    printf(" %s\n", view_serializable ? "SV" : "NV");
+    return text;
 }
 
+/**
+ * @brief Fornece a arena onde o escalonamento schedule_id será construído.
+ */
+typedef Arena* (*ArenaSource)(int schedule_id, void* ctx);
 
-int main() {
-    int time, trans_id;
-    char op_str[2], attr_str[2];
-    
+/**
+ * @brief Destino de cada escalonamento completo cortado da entrada.
+ *
+ * Recebe a posse do escalonamento. Retorna 0 para interromper a leitura.
+ */
+typedef int (*ScheduleSink)(Schedule* s, int schedule_id, void* ctx);
+
+/**
+ * @brief Lê as operações e corta a entrada em escalonamentos.
+ *
+ * Um escalonamento termina quando nenhuma transação está ativa (todas as
+ * que apareceram já fizeram commit).
+ *
+ * @param input A entrada.
+ * @param arena_for Arena de cada escalonamento.
+ * @param sink Destino de cada escalonamento completo.
+ * @param ctx Contexto repassado a arena_for e ao destino.
+ * @return 1 se a entrada foi lida até o fim, 0 em erro.
+ */
+int split_schedules(InputReader* input, ArenaSource arena_for, ScheduleSink sink, void* ctx) {
+    Operation op;
+    int read_status;
     int schedule_counter = 1;
-    Schedule* current_schedule = create_schedule();
+    int ok = 1;
+    Schedule* current_schedule = create_schedule_in(arena_for(schedule_counter, ctx));
+    if (!current_schedule) return 0;
 
     // Estruturas para rastrear transacoes ativas no escalonamento atual
     int* active_trans = NULL;
     int active_trans_count = 0;
     int active_trans_capacity = 0;
 
-    // Lê da entrada padrão ate o final do arquivo
-    while (scanf("%d %d %1s %1s", &time, &trans_id, op_str, attr_str) == 4) {
-        char op = op_str[0];
-        char attr = attr_str[0];
+    // Teste incremental, que aponta a operação que fecha um ciclo
+    ConflictStream* stream = NULL;
+    int stream_on = 1;
+    CommittedSet committed = {NULL, NULL, 1, 0, 0};
+
+    // Com --stats, o tempo fora do destino conta como leitura
+    long long start = stats_clock();
 
+    // Lê a entrada ate o final do arquivo (ou até uma linha mal formada)
+    while (ok && (read_status = input_next(input, &op)) == 1) {
         // Adiciona a operação ao escalonamento que está sendo construído
-        add_operation(current_schedule, time, trans_id, op, attr);
+        add_operation(current_schedule, op.time, op.trans_id, op.op, op.attr);
+
+        if (online_check && stream_on && committed_contains(&committed, op.trans_id)) {
+            // Operação depois do commit: o fluxo pode já ter descartado a transação
+            stream_end(stream);
+            stream = NULL;
+            stream_on = 0;
+        } else if (online_check && stream_on && op.op == 'C' && !committed_add(&committed, op.trans_id)) {
+            ok = 0;
+            break;
+        }
+        if (online_check && stream_on) {
+            if (!stream && !(stream = stream_begin())) {
+                ok = 0;
+                break;
+            }
+            int before = stream_verdict_so_far(stream);
+            int verdict = stream_feed(stream, &op);
+            if (verdict < 0) ok = 0;
+            if (before && verdict == 0) {
+                fprintf(stderr, "escalona: escalonamento %d: ciclo de conflito na operação %ld (tempo %d, transação %d)\n",
+                        schedule_counter, stream_violation(stream), op.time, op.trans_id);
+            }
+        }
 
         // Adiciona a transação na lista de ativas
-        add_active_trans(&active_trans, &active_trans_count, &active_trans_capacity, trans_id);
+        add_active_trans(&active_trans, &active_trans_count, &active_trans_capacity, op.trans_id);
         
         // Se a operação for um commit, a transação deixa de estar ativa
-        if (op == 'C') {
-            remove_active_trans(active_trans, &active_trans_count, trans_id);
+        if (op.op == 'C') {
+            remove_active_trans(active_trans, &active_trans_count, op.trans_id);
         }
 
         // Se não houver mais transacoes ativas, o escalonamento atual terminou e pode ser processado
         if (active_trans_count == 0 && current_schedule->op_count > 0) {
-            process_schedule(current_schedule, schedule_counter);
-            
-            // Limpa e prepara para o próximo escalonamento
+            stats_phase(STAT_PARSE, start);
+            ok = sink(current_schedule, schedule_counter, ctx);
+            start = stats_clock();
+            stream_end(stream);
+            stream = NULL;
+            stream_on = 1;
+            committed_clear(&committed);
+
+            // Prepara para o próximo escalonamento
             schedule_counter++;
-            free_schedule(current_schedule);
-            current_schedule = create_schedule();
+            current_schedule = create_schedule_in(arena_for(schedule_counter, ctx));
+            if (!current_schedule) ok = 0;
             // A lista de transacoes ativas já está vazia, pronta para o próximo
         }
     }
 
+    stats_phase(STAT_PARSE, start);
+
     // Libera a memória alocada que não foi usada
     free_schedule(current_schedule);
-    free(active_trans);
+    arena_free(NULL, active_trans);
+    committed_free(&committed);
+    stream_end(stream);
+
+    return ok && read_status == 0;
+}
+
+// Ordena inteiros em ordem crescente (qsort).
+static int compare_trans_ids(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Modo --gc: analisa os escalonamentos sem guardar as operações.
+ *
+ * Cada operação vai direto para o teste incremental (fluxo.h), que descarta
+ * as transações que já fizeram commit e não podem mais entrar em um ciclo.
+ * O estado do grafo e dos atributos fica proporcional à janela de
+ * transações vivas. Crescem com o escalonamento apenas os IDs das suas
+ * transações, necessários na linha de resultado e na rejeição de operações
+ * depois do commit (ver CommittedSet), e a tabela de nomes de atributos da
+ * entrada, com uma entrada curta por nome distinto; ambos são esvaziados
+ * quando o escalonamento fecha.
+ * O veredito por conflito é o mesmo do modo normal; o por visão sai "NV?"
+ * quando só a busca sobre o histórico completo o decidiria.
+ *
+ * @param input A entrada.
+ * @return 1 se a entrada foi lida até o fim, 0 em erro.
+ */
+int gc_schedules(InputReader* input) {
+    Operation op;
+    int read_status;
+    int schedule_counter = 1;
+    int ok = 1;
+    ConflictStream* stream = NULL;
+
+    int* active_trans = NULL;
+    int active_trans_count = 0;
+    int active_trans_capacity = 0;
+
+    // IDs das transações do escalonamento atual
+    int* trans_ids = NULL;
+    int trans_count = 0;
+    int trans_capacity = 0;
+
+    CommittedSet committed = {NULL, NULL, 1, 0, 0};
+
+    while (ok && (read_status = input_next(input, &op)) == 1) {
+        if (!check_after_commit(&committed, &op, schedule_counter)) {
+            ok = 0;
+            break;
+        }
+        if (!stream && !(stream = stream_begin())) {
+            ok = 0;
+            break;
+        }
+        int before = stream_verdict_so_far(stream);
+        int verdict = stream_feed(stream, &op);
+        if (verdict < 0) {
+            ok = 0;
+            break;
+        }
+        if (online_check && before && verdict == 0) {
+            fprintf(stderr, "escalona: escalonamento %d: ciclo de conflito na operação %ld (tempo %d, transação %d)\n",
+                    schedule_counter, stream_violation(stream), op.time, op.trans_id);
+        }
+
+        int was_active = active_trans_count;
+        add_active_trans(&active_trans, &active_trans_count, &active_trans_capacity, op.trans_id);
+        if (active_trans_count > was_active) {
+            // Transação nova
+            if (trans_count >= trans_capacity) {
+                trans_capacity = (trans_capacity == 0) ? 10 : trans_capacity * 2;
+                int* new_ids = (int*)arena_realloc(NULL, trans_ids, 0, trans_capacity * sizeof(int));
+                if (!new_ids) {
+                    perror("Falha ao realocar lista de transacoes");
+                    ok = 0;
+                    break;
+                }
+                trans_ids = new_ids;
+            }
+            trans_ids[trans_count++] = op.trans_id;
+        }
+        if (op.op == 'C') {
+            remove_active_trans(active_trans, &active_trans_count, op.trans_id);
+        }
+
+        if (active_trans_count == 0) {
+            qsort(trans_ids, trans_count, sizeof(int), compare_trans_ids);
+            int unique = 0;
+            for (int i = 0; i < trans_count; i++) {
+                if (unique == 0 || trans_ids[unique - 1] != trans_ids[i]) trans_ids[unique++] = trans_ids[i];
+            }
+
+            printf("%d ", schedule_counter);
+            for (int i = 0; i < unique; i++) {
+                printf("%d%s", trans_ids[i], (i == unique - 1) ? "" : ",");
+            }
+            int view = stream_view_verdict_so_far(stream);
+            printf(" %s", stream_verdict_so_far(stream) ? "SS" : "NS");
+            printf(" %s\n", view == 1 ? "SV" : (view == 0 ? "NV" : "NV?"));
+
+            schedule_counter++;
+            trans_count = 0;
+            stream_end(stream);
+            stream = NULL;
+            committed_clear(&committed);
+            // Nenhum ID de atributo do escalonamento é usado daqui em diante
+            attr_table_clear(input->attrs);
+        }
+    }
+
+    stream_end(stream);
+    committed_free(&committed);
+    arena_free(NULL, active_trans);
+    arena_free(NULL, trans_ids);
+    return ok && read_status == 0;
+}
 
-    return EXIT_SUCCESS;
+// Arena única dos modos serial e de conversão: um escalonamento por vez.
+static Arena* serial_arena = NULL;
+
+static Arena* serial_arena_for(int schedule_id, void* ctx) {
+    (void)schedule_id;
+    (void)ctx;
+    arena_reset(serial_arena);
+    return serial_arena;
+}
+
+// No modo em lote, cada escalonamento usa a arena da sua posição na janela.
+static Arena* batch_arena_for(int schedule_id, void* ctx) {
+    return batch_arena((BatchPipeline*)ctx, schedule_id);
+}
+
+// Destino do modo serial: analisa e imprime na hora.
+static int serial_sink(Schedule* s, int schedule_id, void* ctx) {
+    (void)ctx;
+    size_t length;
+    char* text = process_schedule(s, schedule_id, &length);
+    if (text) fwrite(text, 1, length, stdout);
+    arena_free(s->arena, text);
+    free_schedule(s);
+    return 1;
+}
+
+// Destino do modo em lote: o pipeline passa a ser dono do escalonamento.
+static int batch_sink(Schedule* s, int schedule_id, void* ctx) {
+    batch_submit((BatchPipeline*)ctx, s, schedule_id);
+    return 1;
+}
+
+// Destino da conversão: grava no arquivo binário.
+static int convert_sink(Schedule* s, int schedule_id, void* ctx) {
+    (void)schedule_id;
+    find_unique_transactions(s);
+    int ok = binary_write_schedule((BinaryWriter*)ctx, s);
+    free_schedule(s);
+    return ok;
+}
+
+/**
+ * @brief Imprime a forma de uso do programa na saída de erro.
+ * @param prog O nome do executável.
+ */
+void print_usage(const char* prog) {
+    fprintf(stderr, "Uso: %s [-t N] [-j N] [--budget N] [--timeout MS] [--checkpoint ARQ]\n", prog);
+    fprintf(stderr, "     %*s [--cache ARQ] [--cache-size N] [--witness] [--classes] [--online]\n",
+            (int)strlen(prog), "");
+    fprintf(stderr, "     %*s [--mem-stats] [--stats] [arquivo]\n", (int)strlen(prog), "");
+    fprintf(stderr, "     %s --gc [arquivo]\n", prog);
+    fprintf(stderr, "     %s --convert saida.bin [arquivo]\n", prog);
+    fprintf(stderr, "     %s --binary [--schedule N] [-t N] [-j N] arquivo.bin\n", prog);
+    fprintf(stderr, "  Sem arquivo, lê da entrada padrão.\n");
+    fprintf(stderr, "  -t, --threads N   threads da busca por permutações do teste por visão e,\n");
+    fprintf(stderr, "                    nos escalonamentos grandes, da geração das arestas de conflito\n");
+    fprintf(stderr, "  -j, --jobs N      analisa até N escalonamentos em paralelo\n");
+    fprintf(stderr, "  --budget N        limita cada teste por visão a N passos de busca (sem\n");
+    fprintf(stderr, "                    resposta no limite, a coluna de visão sai NV?)\n");
+    fprintf(stderr, "  --timeout MS      limita cada teste por visão a MS milissegundos\n");
+    fprintf(stderr, "  --checkpoint ARQ  retoma as buscas interrompidas guardadas em ARQ e guarda\n");
+    fprintf(stderr, "                    ali onde as desta execução pararam\n");
+    fprintf(stderr, "  --cache ARQ       reaproveita vereditos de escalonamentos com a mesma forma,\n");
+    fprintf(stderr, "                    guardados em ARQ entre execuções\n");
+    fprintf(stderr, "  --cache-size N    formas guardadas no cache (padrão %d)\n", CACHE_DEFAULT_CAPACITY);
+    fprintf(stderr, "  --witness         uma linha JSON por escalonamento, com a ordem serial\n");
+    fprintf(stderr, "                    equivalente ou o ciclo/restrição que impede a seriabilidade\n");
+    fprintf(stderr, "                    (não combina com --cache)\n");
+    fprintf(stderr, "  --classes         acrescenta as colunas RC/NR (recuperável), ACA/NA (evita\n");
+    fprintf(stderr, "                    abortos em cascata) e ST/NST (estrito); não combina com --cache\n");
+    fprintf(stderr, "  --convert SAIDA   converte a entrada texto para o formato binário\n");
+    fprintf(stderr, "  --binary          lê a entrada no formato binário\n");
+    fprintf(stderr, "  --schedule N      com --binary, analisa apenas o escalonamento N\n");
+    fprintf(stderr, "  --gc              não guarda as operações: descarta transações concluídas\n");
+    fprintf(stderr, "                    (só teste por conflito; visão indecidível sai NV?)\n");
+    fprintf(stderr, "  --online          aponta na saída de erro a operação que fecha um ciclo de conflito\n");
+    fprintf(stderr, "  --mem-stats       informa na saída de erro as chamadas ao heap\n");
+    fprintf(stderr, "  --stats           informa na saída de erro o tempo por fase, os contadores dos\n");
+    fprintf(stderr, "                    algoritmos, o histograma de latência e os mais lentos\n");
+}
+
+/**
+ * @brief Analisa os escalonamentos de um arquivo binário.
+ * @param path O arquivo binário.
+ * @param only_schedule Escalonamento a analisar (1 = primeiro), ou 0 para todos.
+ * @param batch Pipeline do modo em lote, ou NULL no modo serial.
+ * @return EXIT_SUCCESS ou EXIT_FAILURE.
+ */
+int run_binary(const char* path, long only_schedule, BatchPipeline* batch) {
+    BinaryFile* f = binary_open(path);
+    if (!f) return EXIT_FAILURE;
+    binary_names = f;
+
+    long first = 0, last = binary_schedule_count(f) - 1;
+    if (only_schedule > 0) {
+        // O índice permite ir direto ao escalonamento pedido
+        if (only_schedule > binary_schedule_count(f)) {
+            fprintf(stderr, "%s: escalonamento %ld inexistente\n", path, only_schedule);
+            binary_close(f);
+            return EXIT_FAILURE;
+        }
+        first = last = only_schedule - 1;
+    }
+
+    int ok = 1;
+    for (long n = first; n <= last && ok; n++) {
+        int id = (int)n + 1;
+        Schedule* s = binary_schedule_view(f, n, batch ? batch_arena_for(id, batch) : serial_arena_for(id, NULL));
+        ok = s && (batch ? batch_sink(s, id, batch) : serial_sink(s, id, NULL));
+    }
+
+    // As visões apontam para o mapa: espera o lote antes de fechá-lo
+    batch_finish(batch);
+    binary_names = NULL;
+    binary_close(f);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+int main(int argc, char** argv) {
+    int jobs = 1;
+    long long budget_steps = 0, budget_ms = 0;
+    const char* checkpoint_path = NULL;
+    const char* cache_path = NULL;
+    int cache_size = 0;
+    const char* input_path = NULL;
+    const char* convert_path = NULL;
+    int binary_input = 0;
+    int gc_mode = 0;
+    long only_schedule = 0;
+
+    // Opções de linha de comando
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            int threads = atoi(argv[++i]);
+            set_view_search_threads(threads);
+            set_conflict_threads(threads);
+        } else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budget_steps = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            budget_ms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+            cache_size = atoi(argv[++i]);
+            if (cache_size < 1) cache_size = 1;
+        } else if (strcmp(argv[i], "--convert") == 0 && i + 1 < argc) {
+            convert_path = argv[++i];
+        } else if (strcmp(argv[i], "--binary") == 0) {
+            binary_input = 1;
+        } else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc) {
+            only_schedule = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--gc") == 0) {
+            gc_mode = 1;
+        } else if (strcmp(argv[i], "--witness") == 0) {
+            witness_output = 1;
+        } else if (strcmp(argv[i], "--classes") == 0) {
+            classes_output = 1;
+        } else if (strcmp(argv[i], "--online") == 0) {
+            online_check = 1;
+        } else if (strcmp(argv[i], "--mem-stats") == 0) {
+            mem_stats = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats_enable();
+        } else if (argv[i][0] != '-' && !input_path) {
+            input_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((binary_input && (!input_path || convert_path)) || (only_schedule && !binary_input) ||
+        (gc_mode && (binary_input || convert_path || jobs > 1 || stats_enabled() || checkpoint_path || cache_path || cache_size)) ||
+        ((witness_output || classes_output) && (gc_mode || cache_path || cache_size))) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    set_view_search_budget(budget_steps, budget_ms);
+    if (checkpoint_path && !convert_path && !(checkpoints = checkpoint_load(checkpoint_path))) {
+        return EXIT_FAILURE;
+    }
+    if ((cache_path || cache_size) && !convert_path) {
+        verdict_cache = cache_create(cache_size ? cache_size : CACHE_DEFAULT_CAPACITY);
+        if (!verdict_cache) {
+            checkpoint_free(checkpoints);
+            return EXIT_FAILURE;
+        }
+        if (cache_path) cache_load(verdict_cache, cache_path);
+    }
+
+    // No modo em lote, os escalonamentos completos vão para o pipeline
+    BatchPipeline* batch = NULL;
+    if (jobs > 1 && !convert_path) {
+        batch = batch_start(jobs, jobs * BATCH_QUEUE_PER_WORKER, process_schedule, stdout);
+        if (!batch) return EXIT_FAILURE;
+    } else {
+        serial_arena = arena_create(0);
+        if (!serial_arena) return EXIT_FAILURE;
+    }
+
+    int ok;
+    if (binary_input) {
+        ok = run_binary(input_path, only_schedule, batch) == EXIT_SUCCESS;
+    } else {
+        InputReader* input = input_open(input_path);
+        if (!input) {
+            batch_finish(batch);
+            arena_destroy(serial_arena);
+            return EXIT_FAILURE;
+        }
+        attr_names = input->attrs;
+
+        if (gc_mode) {
+            ok = gc_schedules(input);
+        } else if (convert_path) {
+            BinaryWriter* writer = binary_create(convert_path);
+            ok = writer && split_schedules(input, serial_arena_for, convert_sink, writer);
+            if (writer && !binary_close_writer(writer, input->attrs)) ok = 0;
+        } else if (batch) {
+            ok = split_schedules(input, batch_arena_for, batch_sink, batch);
+        } else {
+            ok = split_schedules(input, serial_arena_for, serial_sink, NULL);
+        }
+
+        // Espera os escalonamentos ainda em análise no modo em lote
+        batch_finish(batch);
+        input_close(input);
+    }
+
+    if (mem_stats) {
+        // Contagem antes de liberar as arenas: em regime, nenhuma análise chama o heap
+        fprintf(stderr, "escalona: %ld chamadas ao heap; %ld de %ld escalonamentos chamaram o heap na análise\n",
+                arena_heap_calls(), atomic_load(&schedules_using_heap), atomic_load(&schedules_analyzed));
+    }
+    stats_report(stderr);
+    if (checkpoints && !checkpoint_save(checkpoints, checkpoint_path)) ok = 0;
+    checkpoint_free(checkpoints);
+    if (verdict_cache) {
+        cache_report(verdict_cache, stderr);
+        if (cache_path && !cache_save(verdict_cache, cache_path)) ok = 0;
+        cache_free(verdict_cache);
+    }
+    arena_destroy(serial_arena);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file retomada.c
+ * @brief Implementação do arquivo de pontos de parada do teste por visão.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "retomada.h"
+
+// Maior caminho aceito na leitura. Caminhos reais têm no máximo uma entrada
+// por transação (S) ou por escolha do polígrafo (P); um tamanho maior só vem
+// de um arquivo corrompido e não deve virar uma alocação gigante.
+#define CHECKPOINT_MAX_LENGTH (1 << 24)
+
+typedef struct {
+    int schedule_id;
+    uint64_t fingerprint;
+    ViewResumeKind kind;
+    int length;
+    int* path;
+    int consumed;   // Já entregue por checkpoint_find (não é gravado de novo)
+} CheckpointEntry;
+
+struct CheckpointStore {
+    CheckpointEntry* entries;  // [0, loaded): lidas, por número; depois, as novas
+    int loaded;
+    int count;
+    int capacity;
+    pthread_mutex_t lock;      // As análises do modo em lote consultam em paralelo
+};
+
+static int compare_entries(const void* a, const void* b) {
+    int x = ((const CheckpointEntry*)a)->schedule_id, y = ((const CheckpointEntry*)b)->schedule_id;
+    return (x > y) - (x < y);
+}
+
+// Acrescenta uma entrada (a posse de path passa ao conjunto). 0 em erro.
+static int append_entry(CheckpointStore* store, CheckpointEntry e) {
+    if (store->count >= store->capacity) {
+        int cap = store->capacity ? store->capacity * 2 : 16;
+        CheckpointEntry* grown = (CheckpointEntry*)realloc(store->entries, cap * sizeof(CheckpointEntry));
+        if (!grown) {
+            perror("Falha ao alocar pontos de parada");
+            return 0;
+        }
+        store->entries = grown;
+        store->capacity = cap;
+    }
+    store->entries[store->count++] = e;
+    return 1;
+}
+
+CheckpointStore* checkpoint_load(const char* path) {
+    CheckpointStore* store = (CheckpointStore*)calloc(1, sizeof(CheckpointStore));
+    if (!store) {
+        perror("Falha ao alocar pontos de parada");
+        return NULL;
+    }
+    pthread_mutex_init(&store->lock, NULL);
+
+    FILE* f = fopen(path, "r");
+    if (!f) return store; // Primeira execução: nada a retomar
+
+    CheckpointEntry e;
+    char kind;
+    int ok = 1;
+    while (ok && fscanf(f, "%d %" SCNx64 " %c %d", &e.schedule_id, &e.fingerprint, &kind, &e.length) == 4) {
+        if ((kind != 'P' && kind != 'S') || e.length < 0 || e.length > CHECKPOINT_MAX_LENGTH) break;
+        e.kind = (kind == 'P') ? VIEW_RESUME_POLYGRAPH : VIEW_RESUME_PERMUTATION;
+        e.consumed = 0;
+        e.path = (int*)malloc((e.length + 1) * sizeof(int));
+        if (!e.path) {
+            perror("Falha ao alocar pontos de parada");
+            ok = 0;
+            break;
+        }
+        for (int i = 0; ok && i < e.length; i++) {
+            ok = fscanf(f, "%d", &e.path[i]) == 1;
+        }
+        if (!ok || !append_entry(store, e)) {
+            free(e.path);
+            ok = 0;
+        }
+    }
+    if (!feof(f) || !ok) {
+        fprintf(stderr, "%s: arquivo de pontos de parada inválido\n", path);
+        fclose(f);
+        checkpoint_free(store);
+        return NULL;
+    }
+    fclose(f);
+
+    if (store->count) qsort(store->entries, store->count, sizeof(CheckpointEntry), compare_entries);
+    store->loaded = store->count;
+    return store;
+}
+
+uint64_t schedule_fingerprint(const Schedule* s) {
+    // FNV-1a de 64 bits sobre (transação, tipo, atributo) de cada operação
+    uint64_t h = 14695981039346656037ull;
+    for (int i = 0; i < s->op_count; i++) {
+        const Operation* op = &s->ops[i];
+        uint32_t fields[3] = {(uint32_t)op->trans_id, (uint32_t)(unsigned char)op->op, (uint32_t)op->attr_idx};
+        const unsigned char* bytes = (const unsigned char*)fields;
+        for (size_t k = 0; k < sizeof(fields); k++) {
+            h ^= bytes[k];
+            h *= 1099511628211ull;
+        }
+    }
+    return h;
+}
+
+void checkpoint_find(CheckpointStore* store, int schedule_id, uint64_t fingerprint, ViewCheckpoint* out) {
+    *out = (ViewCheckpoint){VIEW_RESUME_NONE, 0, NULL};
+    pthread_mutex_lock(&store->lock);
+    int lo = 0, hi = store->loaded;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (store->entries[mid].schedule_id < schedule_id) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < store->loaded && store->entries[lo].schedule_id == schedule_id) {
+        CheckpointEntry* e = &store->entries[lo];
+        e->consumed = 1;
+        if (e->fingerprint == fingerprint) *out = (ViewCheckpoint){e->kind, e->length, e->path};
+    }
+    pthread_mutex_unlock(&store->lock);
+}
+
+int checkpoint_record(CheckpointStore* store, int schedule_id, uint64_t fingerprint, const ViewCheckpoint* stopped) {
+    if (stopped->kind == VIEW_RESUME_NONE) return 1;
+    CheckpointEntry e = {schedule_id, fingerprint, stopped->kind, stopped->length, NULL, 0};
+    e.path = (int*)malloc((e.length + 1) * sizeof(int));
+    if (!e.path) {
+        perror("Falha ao alocar pontos de parada");
+        return 0;
+    }
+    memcpy(e.path, stopped->path, e.length * sizeof(int));
+
+    pthread_mutex_lock(&store->lock);
+    int ok = append_entry(store, e);
+    pthread_mutex_unlock(&store->lock);
+    if (!ok) free(e.path);
+    return ok;
+}
+
+int checkpoint_save(CheckpointStore* store, const char* path) {
+    // Pontos lidos e não consumidos (escalonamentos não analisados agora) continuam valendo
+    int kept = 0;
+    for (int i = 0; i < store->count; i++) {
+        if (i >= store->loaded || !store->entries[i].consumed) store->entries[kept++] = store->entries[i];
+        else free(store->entries[i].path);
+    }
+    store->count = kept;
+    store->loaded = 0;
+    if (store->count) qsort(store->entries, store->count, sizeof(CheckpointEntry), compare_entries);
+
+    // Grava ao lado e troca no fim: se a gravação for interrompida, o
+    // arquivo anterior continua valendo para a próxima retomada
+    size_t path_len = strlen(path);
+    char* tmp_path = (char*)malloc(path_len + sizeof(".tmp"));
+    if (!tmp_path) {
+        perror("Falha ao alocar pontos de parada");
+        return 0;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE* f = fopen(tmp_path, "w");
+    if (!f) {
+        perror(tmp_path);
+        free(tmp_path);
+        return 0;
+    }
+    for (int i = 0; i < store->count; i++) {
+        CheckpointEntry* e = &store->entries[i];
+        fprintf(f, "%d %016" PRIx64 " %c %d", e->schedule_id, e->fingerprint,
+                e->kind == VIEW_RESUME_POLYGRAPH ? 'P' : 'S', e->length);
+        for (int k = 0; k < e->length; k++) fprintf(f, " %d", e->path[k]);
+        fputc('\n', f);
+    }
+    int ok = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        perror(path);
+        remove(tmp_path);
+        free(tmp_path);
+        return 0;
+    }
+    free(tmp_path);
+    return 1;
+}
+
+void checkpoint_free(CheckpointStore* store) {
+    if (!store) return;
+    for (int i = 0; i < store->count; i++) free(store->entries[i].path);
+    free(store->entries);
+    pthread_mutex_destroy(&store->lock);
+    free(store);
+}
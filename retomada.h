@@ -0,0 +1,82 @@
+/**
+ * @file retomada.h
+ * @brief Arquivo de pontos de parada do teste por visão (opção --checkpoint).
+ *
+ * Quando o orçamento do teste por visão acaba (ver set_view_search_budget),
+ * o ponto onde a busca parou é guardado junto com o número do escalonamento
+ * e uma impressão digital das suas operações. Numa execução posterior sobre
+ * a mesma entrada, a busca continua desse ponto; se o escalonamento mudou,
+ * a impressão digital não confere e a busca recomeça do início.
+ *
+ * O arquivo é texto, uma linha por escalonamento:
+ *   número impressão-digital P|S tamanho caminho...
+ * (P: decisões do polígrafo, S: prefixo da enumeração de permutações).
+ */
+#ifndef RETOMADA_H
+#define RETOMADA_H
+
+#include <stdint.h>
+#include "algoritmos.h"
+
+/**
+ * @struct CheckpointStore
+ * @brief Pontos lidos do arquivo e pontos novos desta execução (opaco).
+ */
+typedef struct CheckpointStore CheckpointStore;
+
+/**
+ * @brief Lê os pontos de parada de um arquivo.
+ * @param path O arquivo (se não existir, começa vazio).
+ * @return O conjunto lido, ou NULL em caso de erro (já reportado).
+ */
+CheckpointStore* checkpoint_load(const char* path);
+
+/**
+ * @brief Impressão digital das operações de um escalonamento.
+ * @param s O escalonamento (com find_unique_transactions já chamado).
+ * @return Um hash de transações, tipos e índices de atributo das operações.
+ */
+uint64_t schedule_fingerprint(const Schedule* s);
+
+/**
+ * @brief Procura o ponto de parada guardado para um escalonamento.
+ *
+ * O ponto encontrado é consumido: se a busca parar de novo, o novo ponto
+ * deve ser registrado com checkpoint_record.
+ *
+ * @param store O conjunto.
+ * @param schedule_id O número do escalonamento.
+ * @param fingerprint A impressão digital atual do escalonamento.
+ * @param out Recebe o ponto (path pertence ao conjunto), ou kind VIEW_RESUME_NONE.
+ */
+void checkpoint_find(CheckpointStore* store, int schedule_id, uint64_t fingerprint, ViewCheckpoint* out);
+
+/**
+ * @brief Registra onde a busca de um escalonamento parou nesta execução.
+ * @param store O conjunto.
+ * @param schedule_id O número do escalonamento.
+ * @param fingerprint A impressão digital do escalonamento.
+ * @param stopped O ponto de parada (copiado).
+ * @return 1 em caso de sucesso, 0 em falha de alocação.
+ */
+int checkpoint_record(CheckpointStore* store, int schedule_id, uint64_t fingerprint, const ViewCheckpoint* stopped);
+
+/**
+ * @brief Grava os pontos novos e os lidos que não foram consumidos.
+ *
+ * O conteúdo vai primeiro para path.tmp, que depois substitui path: uma
+ * gravação interrompida não apaga os pontos da execução anterior.
+ *
+ * @param store O conjunto.
+ * @param path O arquivo (sobrescrito).
+ * @return 1 em caso de sucesso, 0 em erro de escrita.
+ */
+int checkpoint_save(CheckpointStore* store, const char* path);
+
+/**
+ * @brief Libera o conjunto.
+ * @param store O conjunto (pode ser NULL).
+ */
+void checkpoint_free(CheckpointStore* store);
+
+#endif // RETOMADA_H